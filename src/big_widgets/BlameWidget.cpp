@@ -6,7 +6,7 @@
 #include <CommitHistoryView.h>
 #include <CommitInfo.h>
 #include <FileBlameWidget.h>
-#include <GitHistory.h>
+#include <FileHistoryLoader.h>
 #include <GitQlientSettings.h>
 #include <RepositoryViewDelegate.h>
 
@@ -32,6 +32,7 @@ BlameWidget::BlameWidget(const QSharedPointer<GitCache> &cache, const QSharedPoi
    , mRepoView(new CommitHistoryView(mCache, mGit, mSettings, this))
    , mFileSystemView(new QTreeView(this))
    , mTabWidget(new QTabWidget(this))
+   , mHistoryLoader(new FileHistoryLoader(mCache, mGit, this))
 {
    mTabWidget->setObjectName("HistoryTab");
    mRepoView->setObjectName("blameGraphView");
@@ -50,6 +51,12 @@ BlameWidget::BlameWidget(const QSharedPointer<GitCache> &cache, const QSharedPoi
    mRepoView->filterBySha({});
    connect(mRepoView, &CommitHistoryView::customContextMenuRequested, this, &BlameWidget::showRepoViewMenu);
    connect(mRepoView, &CommitHistoryView::clicked, this, &BlameWidget::reloadBlame);
+   connect(mHistoryLoader, &FileHistoryLoader::shasFound, this, &BlameWidget::onFileHistoryFound);
+   connect(mHistoryLoader, &FileHistoryLoader::finished, this, [this](const QString &file) {
+      // A file without history can't be blamed.
+      if (file == mPendingFile)
+         mPendingFile.clear();
+   });
 
    mFileSystemModel->setFilter(QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot);
 
@@ -75,6 +82,8 @@ BlameWidget::BlameWidget(const QSharedPointer<GitCache> &cache, const QSharedPoi
    connect(mTabWidget, &QTabWidget::tabCloseRequested, mTabWidget, [this](int index) {
       if (index == mLastTabIndex)
       {
+         mHistoryLoader->cancel();
+         mShaToSelect.clear();
          mFileSystemView->clearSelection();
          mRepoView->blockSignals(true);
          mRepoView->filterBySha({});
@@ -111,56 +120,94 @@ void BlameWidget::showFileHistory(const QString &filePath)
 {
    if (!mTabsMap.contains(filePath))
    {
-      QScopedPointer<GitHistory> git(new GitHistory(mGit));
-      auto ret = git->history(filePath);
+      QStringList shaHistory;
 
-      if (ret.success)
+      if (mHistoryLoader->history(filePath, &shaHistory))
       {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-         auto shaHistory = ret.output.split("\n", Qt::SkipEmptyParts);
-#else
-         auto shaHistory = ret.output.split("\n", QString::SkipEmptyParts);
-#endif
-         for (auto i = 0; i < shaHistory.size();)
-         {
-            if (shaHistory.at(i).startsWith("gpg:"))
-            {
-               shaHistory.takeAt(i);
-
-               if (shaHistory.size() <= i)
-                  break;
-            }
-            else
-               ++i;
-         }
+         mHistoryLoader->cancel();
+         mPendingFile.clear();
+         mShaToSelect.clear();
 
          mRepoView->blockSignals(true);
          mRepoView->filterBySha(shaHistory);
          mRepoView->blockSignals(false);
 
-         const auto previousSha = shaHistory.count() > 1 ? shaHistory.at(1) : QString(tr("No info"));
-         const auto fileBlameWidget = new FileBlameWidget(mCache, mGit);
-
-         fileBlameWidget->setup(filePath, shaHistory.constFirst(), previousSha);
-         connect(fileBlameWidget, &FileBlameWidget::signalCommitSelected, mRepoView, &CommitHistoryView::focusOnCommit);
+         addBlameTab(filePath, shaHistory);
+      }
+      else
+      {
+         // The tab is opened when the first commits are found.
+         mPendingFile = filePath;
+         mShaToSelect.clear();
 
-         const auto index = mTabWidget->addTab(fileBlameWidget, filePath.split("/").last());
-         mTabWidget->setTabsClosable(true);
-         mTabWidget->blockSignals(true);
-         mTabWidget->setCurrentIndex(index);
-         mTabWidget->blockSignals(false);
+         mRepoView->blockSignals(true);
+         mRepoView->filterBySha({});
+         mRepoView->blockSignals(false);
 
-         mLastTabIndex = index;
-         mTabsMap.insert(filePath, fileBlameWidget);
+         mHistoryLoader->load(filePath);
       }
    }
    else
       mTabWidget->setCurrentWidget(mTabsMap.value(filePath));
 }
 
+void BlameWidget::addBlameTab(const QString &filePath, const QStringList &shaHistory)
+{
+   // The new tab is shown without notifying it, so the blame of the file that is hidden is cancelled here.
+   if (const auto currentBlame = qobject_cast<FileBlameWidget *>(mTabWidget->currentWidget()))
+      currentBlame->cancel();
+
+   const auto previousSha = shaHistory.count() > 1 ? shaHistory.at(1) : QString(tr("No info"));
+   const auto fileBlameWidget = new FileBlameWidget(mCache, mGit);
+
+   fileBlameWidget->setup(filePath, shaHistory.constFirst(), previousSha);
+   connect(fileBlameWidget, &FileBlameWidget::signalCommitSelected, mRepoView, &CommitHistoryView::focusOnCommit);
+
+   const auto index = mTabWidget->addTab(fileBlameWidget, filePath.split("/").last());
+   mTabWidget->setTabsClosable(true);
+   mTabWidget->blockSignals(true);
+   mTabWidget->setCurrentIndex(index);
+   mTabWidget->blockSignals(false);
+
+   mLastTabIndex = index;
+   mTabsMap.insert(filePath, fileBlameWidget);
+}
+
+void BlameWidget::onFileHistoryFound(const QString &file, const QStringList &shas)
+{
+   mRepoView->blockSignals(true);
+   mRepoView->addToFilter(shas);
+
+   if (file == mPendingFile)
+   {
+      mPendingFile.clear();
+
+      if (!mTabsMap.contains(file))
+         addBlameTab(file, shas);
+   }
+   else if (!mShaToSelect.isEmpty())
+   {
+      for (const auto &sha : shas)
+      {
+         if (sha.startsWith(mShaToSelect))
+         {
+            if (selectCommit(mShaToSelect))
+               mShaToSelect.clear();
+
+            break;
+         }
+      }
+   }
+
+   mRepoView->blockSignals(false);
+}
+
 void BlameWidget::onNewRevisions(int totalCommits)
 {
    mRepoModel->onNewRevisions(totalCommits);
+
+   // The references may have changed: the histories loaded for the previous HEAD are not valid anymore.
+   mHistoryLoader->invalidate();
 }
 
 void BlameWidget::reloadBlame(const QModelIndex &index)
@@ -184,53 +231,61 @@ void BlameWidget::reloadHistory(int tabIndex)
    {
       mLastTabIndex = tabIndex;
 
+      // Only the blame of the visible file keeps running.
+      for (auto i = 0; i < mTabWidget->count(); ++i)
+      {
+         if (i != tabIndex)
+            qobject_cast<FileBlameWidget *>(mTabWidget->widget(i))->cancel();
+      }
+
       const auto blameWidget = qobject_cast<FileBlameWidget *>(mTabWidget->widget(tabIndex));
       const auto sha = blameWidget->getCurrentSha();
       const auto file = blameWidget->getCurrentFile();
 
-      QScopedPointer<GitHistory> git(new GitHistory(mGit));
-      const auto ret = git->history(file);
+      blameWidget->resume();
 
-      if (ret.success)
-      {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-         auto shaHistory = ret.output.split("\n", Qt::SkipEmptyParts);
-#else
-         auto shaHistory = ret.output.split("\n", QString::SkipEmptyParts);
-#endif
-         for (auto i = 0; i < shaHistory.size();)
-         {
-            if (shaHistory.at(i).startsWith("gpg:"))
-            {
-               shaHistory.takeAt(i);
-
-               if (shaHistory.size() <= i)
-                  break;
-            }
-            else
-               ++i;
-         }
+      mPendingFile.clear();
 
-         mRepoView->blockSignals(true);
+      mRepoView->blockSignals(true);
+
+      if (QStringList shaHistory; mHistoryLoader->history(file, &shaHistory))
+      {
+         mHistoryLoader->cancel();
+         mShaToSelect.clear();
          mRepoView->filterBySha(shaHistory);
+         selectCommit(sha);
+      }
+      else
+      {
+         // The commit is selected when it's found.
+         mShaToSelect = sha;
+         mRepoView->filterBySha({});
+         mHistoryLoader->load(file);
+      }
 
-         const auto repoModel = mRepoView->model();
-         const auto totalRows = repoModel->rowCount();
-         for (auto i = 0; i < totalRows; ++i)
-         {
-            const auto index = mRepoView->model()->index(i, static_cast<int>(CommitHistoryColumns::Sha));
-
-            if (index.data().toString().startsWith(sha))
-            {
-               mRepoView->setCurrentIndex(index);
-               mRepoView->selectionModel()->select(index,
-                                                   QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
-            }
-         }
+      mRepoView->blockSignals(false);
+   }
+}
 
-         mRepoView->blockSignals(false);
+bool BlameWidget::selectCommit(const QString &sha)
+{
+   const auto repoModel = mRepoView->model();
+   const auto totalRows = repoModel->rowCount();
+
+   for (auto i = 0; i < totalRows; ++i)
+   {
+      const auto index = repoModel->index(i, static_cast<int>(CommitHistoryColumns::Sha));
+
+      if (index.data().toString().startsWith(sha))
+      {
+         mRepoView->setCurrentIndex(index);
+         mRepoView->selectionModel()->select(index, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+
+         return true;
       }
    }
+
+   return false;
 }
 
 void BlameWidget::showFileSystemMenu(const QPoint &pos)
@@ -25,11 +25,13 @@
 
 #include <QFrame>
 #include <QMap>
+#include <QStringList>
 
 class GitCache;
 class GitBase;
 class QFileSystemModel;
 class FileBlameWidget;
+class FileHistoryLoader;
 class QTreeView;
 class CommitHistoryModel;
 class CommitHistoryView;
@@ -111,6 +113,9 @@ private:
    CommitHistoryView *mRepoView = nullptr;
    QTreeView *mFileSystemView = nullptr;
    QTabWidget *mTabWidget = nullptr;
+   FileHistoryLoader *mHistoryLoader = nullptr;
+   QString mPendingFile;
+   QString mShaToSelect;
    QString mWorkingDirectory;
    QMap<QString, FileBlameWidget *> mTabsMap;
    RepositoryViewDelegate *mItemDelegate = nullptr;
@@ -146,6 +151,28 @@ private:
     * @param tabIndex The new tab index selected.
     */
    void reloadHistory(int tabIndex);
+   /**
+    * @brief Adds the commits of the file history as they are loaded to the history view. When they belong to a file
+    * that is waiting to be opened, the blame tab is created with the most recent commit.
+    *
+    * @param file The file whose history is being loaded.
+    * @param shas The SHAs of the commits found.
+    */
+   void onFileHistoryFound(const QString &file, const QStringList &shas);
+   /**
+    * @brief Opens the blame tab of a file once its history is known.
+    *
+    * @param filePath The full file path.
+    * @param shaHistory The SHAs of the commits that modified the file, from the newest to the oldest.
+    */
+   void addBlameTab(const QString &filePath, const QStringList &shaHistory);
+   /**
+    * @brief Selects the commit in the history view if it's already listed.
+    *
+    * @param sha The SHA of the commit.
+    * @return True if the commit was found.
+    */
+   bool selectCommit(const QString &sha);
 
    void showFileSystemMenu(const QPoint &pos);
 
@@ -165,6 +165,15 @@ GitQlientRepo::GitQlientRepo(const QSharedPointer<GitBase> &git, const QSharedPo
 
    connect(mGitLoader.data(), &GitRepoLoader::signalLoadingStarted, this, &GitQlientRepo::createProgressDialog);
    connect(mGitLoader.data(), &GitRepoLoader::signalLoadingFinished, this, &GitQlientRepo::onRepoLoadFinished);
+   connect(mGitLoader.data(), &GitRepoLoader::signalRevisionsAppended, this, &GitQlientRepo::onRevisionsAppended);
+   connect(mGitLoader.data(), &GitRepoLoader::signalRevisionsInserted, this, &GitQlientRepo::onRevisionsInserted);
+   connect(mGitLoader.data(), &GitRepoLoader::signalMetadataLoaded, mHistoryWidget,
+           &HistoryWidget::updateGraphMetadata);
+   connect(mGitLoader.data(), &GitRepoLoader::signalRevisionsPageLoaded, mHistoryWidget,
+           &HistoryWidget::appendGraphPage);
+   connect(mGitLoader.data(), &GitRepoLoader::signalMoreRevisionsAvailable, mHistoryWidget,
+           &HistoryWidget::setMoreGraphRevisions);
+   connect(mHistoryWidget, &HistoryWidget::loadMoreRevisions, mGitLoader.data(), &GitRepoLoader::loadMoreRevisions);
 
    m_loaderThread = new QThread();
    mGitLoader->moveToThread(m_loaderThread);
@@ -176,6 +185,10 @@ GitQlientRepo::GitQlientRepo(const QSharedPointer<GitBase> &git, const QSharedPo
    m_loaderThread->start();
 
    mGitLoader->setShowAll(mSettings->localValue("ShowAllBranches", true).toBool());
+
+   // The lists of changed files are kept within a memory budget, in MB.
+   const auto revisionFilesBudget = mSettings->globalValue("RevisionFilesCacheSize", 64).toLongLong();
+   mGitQlientCache->setRevisionFilesBudget(revisionFilesBudget * 1024 * 1024);
 }
 
 GitQlientRepo::~GitQlientRepo()
@@ -337,7 +350,15 @@ void GitQlientRepo::onRepoLoadFinished()
       return;
    }
 
-   mHistoryWidget->updateGraphView(totalCommits);
+   if (mHistoryStreamed)
+   {
+      mHistoryStreamed = false;
+      mHistoryWidget->appendGraphRevisions(totalCommits);
+   }
+   else if (mHistoryRefreshed)
+      mHistoryRefreshed = false;
+   else
+      mHistoryWidget->updateGraphView(totalCommits);
 
    mBlameWidget->onNewRevisions(totalCommits);
 
@@ -367,6 +388,26 @@ void GitQlientRepo::onRepoLoadFinished()
    emit currentBranchChanged();
 }
 
+void GitQlientRepo::onRevisionsAppended(int totalCommits)
+{
+   if (mHistoryStreamed)
+      mHistoryWidget->appendGraphRevisions(totalCommits);
+   else
+   {
+      mHistoryStreamed = true;
+      mHistoryWidget->updateGraphView(totalCommits);
+
+      if (mWaitDlg)
+         mWaitDlg->close();
+   }
+}
+
+void GitQlientRepo::onRevisionsInserted(int firstRow, int count)
+{
+   mHistoryRefreshed = true;
+   mHistoryWidget->insertGraphRevisions(firstRow, count);
+}
+
 void GitQlientRepo::loadFileDiff(const QString &currentSha, const QString &previousSha, const QString &file)
 {
    const auto loaded = mDiffWidget->loadFileDiff(currentSha, previousSha, file);
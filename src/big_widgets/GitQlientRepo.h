@@ -181,6 +181,8 @@ private:
    QSharedPointer<GitServer::IRestApi> mApi;
 
    bool mIsInit = false;
+   bool mHistoryStreamed = false;
+   bool mHistoryRefreshed = false;
    QThread *m_loaderThread;
 
    /*!
@@ -228,6 +230,17 @@ private:
     * @brief When the loading finishes this method closes and destroys the dialog.
     */
    void onRepoLoadFinished();
+   /**
+    * @brief Shows the revisions loaded so far while the repository is still loading.
+    * @param totalCommits The total of commits loaded so far.
+    */
+   void onRevisionsAppended(int totalCommits);
+   /**
+    * @brief Shows the revisions that an incremental refresh added to the top of the history.
+    * @param firstRow The first row inserted.
+    * @param count The number of revisions inserted.
+    */
+   void onRevisionsInserted(int firstRow, int count);
    /*!
     \brief Loads the view to show the diff of a specific file.
 
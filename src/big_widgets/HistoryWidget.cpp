@@ -3,10 +3,12 @@
 #include <AmendWidget.h>
 #include <BranchesWidget.h>
 #include <CheckBox.h>
+#include <CommitHistoryColumns.h>
 #include <CommitHistoryModel.h>
 #include <CommitHistoryView.h>
 #include <CommitInfo.h>
 #include <CommitInfoWidget.h>
+#include <ContentSearch.h>
 #include <FileDiffWidget.h>
 #include <FileEditor.h>
 #include <FullDiffWidget.h>
@@ -23,6 +25,7 @@
 #include <GitRepoLoader.h>
 #include <GitWip.h>
 #include <RepositoryViewDelegate.h>
+#include <RevisionFilesPrefetcher.h>
 #include <WipHelper.h>
 #include <WipWidget.h>
 
@@ -43,6 +46,12 @@
 
 using namespace QLogger;
 
+namespace
+{
+const int SEARCH_DELAY_MS = 250;
+const int MIN_SEARCH_SIZE = 3;
+}
+
 HistoryWidget::HistoryWidget(const QSharedPointer<GitCache> &cache, const QSharedPointer<GitBase> git,
                              const QSharedPointer<GitQlientSettings> &settings, QWidget *parent)
    : QFrame(parent)
@@ -53,6 +62,7 @@ HistoryWidget::HistoryWidget(const QSharedPointer<GitCache> &cache, const QShare
    , mUserName(new QLabel(this))
    , mUserEmail(new QLabel(this))
    , mSplitter(new QSplitter(this))
+   , mPrefetcher(new RevisionFilesPrefetcher(mGit, mCache, this))
 {
    QLog_Info("Performance", "HistoryWidget loading...");
    setAttribute(Qt::WA_DeleteOnClose);
@@ -135,11 +145,22 @@ HistoryWidget::HistoryWidget(const QSharedPointer<GitCache> &cache, const QShare
    mSearchInput = new QLineEdit(this);
    mSearchInput->setObjectName("SearchInput");
 
-   mSearchInput->setPlaceholderText(
-       tr("Press Return/Enter to search by SHA/message. Press Ctrl+Return/Enter to cherry-pick the SHA."));
+   mSearchInput->setPlaceholderText(tr("Type to search by SHA/message/author. Press Return/Enter to go to the next "
+                                       "match. Press Ctrl+Return/Enter to cherry-pick the SHA."));
    connect(mSearchInput, &QLineEdit::returnPressed, this, &HistoryWidget::search);
 
+   mSearchTimer = new QTimer(this);
+   mSearchTimer->setSingleShot(true);
+   mSearchTimer->setInterval(SEARCH_DELAY_MS);
+   connect(mSearchTimer, &QTimer::timeout, this, &HistoryWidget::searchAsYouType);
+   connect(mSearchInput, &QLineEdit::textEdited, mSearchTimer, qOverload<>(&QTimer::start));
+   connect(mCache.get(), &GitCache::signalSearchIndexUpdated, this, [this]() {
+      if (mSearchPending)
+         searchAsYouType();
+   });
+
    mRepositoryModel = new CommitHistoryModel(mCache, mGit);
+   connect(mRepositoryModel, &CommitHistoryModel::signalFetchMore, this, &HistoryWidget::loadMoreRevisions);
    mRepositoryView = new CommitHistoryView(mCache, mGit, mSettings, this);
 
    connect(mRepositoryView, &CommitHistoryView::fullReload, this, &HistoryWidget::fullReload);
@@ -193,10 +214,37 @@ HistoryWidget::HistoryWidget(const QSharedPointer<GitCache> &cache, const QShare
    mChShowAllBranches->setChecked(mSettings->localValue("ShowAllBranches", true).toBool());
    connect(mChShowAllBranches, &CheckBox::toggled, this, &HistoryWidget::onShowAllUpdated);
 
+   mContentSearch = new ContentSearch(mGit, this);
+   connect(mContentSearch, &ContentSearch::shasFound, mRepositoryView, &CommitHistoryView::addToFilter);
+   connect(mContentSearch, &ContentSearch::shasFound, this, [this]() {
+      mContentSearchStatus->setText(tr("Searching... %1 commits found").arg(mContentSearch->found()));
+   });
+   connect(mContentSearch, &ContentSearch::finished, this, [this](bool success) {
+      mContentSearchStatus->setText(success ? tr("%1 commits found").arg(mContentSearch->found())
+                                            : tr("The search failed"));
+   });
+
+   mChContentSearch = new CheckBox(tr("Search in changes"), this);
+   mChContentSearch->setToolTip(tr("Press Return/Enter to show the commits whose changes add or remove the text. Write "
+                                   "the text between slashes (/text/) to search with a regular expression."));
+   connect(mChContentSearch, &CheckBox::toggled, this, [this](bool checked) {
+      if (!checked)
+         stopContentSearch();
+   });
+   connect(mSearchInput, &QLineEdit::textEdited, this, [this](const QString &text) {
+      if (text.isEmpty() && mChContentSearch->isChecked())
+         stopContentSearch();
+   });
+
+   mContentSearchStatus = new QLabel(this);
+   mContentSearchStatus->setVisible(false);
+
    const auto graphOptionsLayout = new QHBoxLayout();
    graphOptionsLayout->setContentsMargins(QMargins());
    graphOptionsLayout->setSpacing(10);
    graphOptionsLayout->addWidget(mSearchInput);
+   graphOptionsLayout->addWidget(mChContentSearch);
+   graphOptionsLayout->addWidget(mContentSearchStatus);
    graphOptionsLayout->addWidget(cherryPickBtn);
    graphOptionsLayout->addWidget(mChShowAllBranches);
 
@@ -282,6 +330,8 @@ void HistoryWidget::enableGitServerFeatures(const QSharedPointer<IGitServerCache
 
 void HistoryWidget::clear()
 {
+   stopContentSearch();
+
    mRepositoryView->clear();
    resetWip();
    mBranchesWidget->clear();
@@ -327,6 +377,32 @@ void HistoryWidget::updateGraphView(int totalCommits)
    focusOnCommit(currentSha);
 }
 
+void HistoryWidget::appendGraphRevisions(int totalCommits)
+{
+   mRepositoryModel->onRevisionsAppended(totalCommits);
+}
+
+void HistoryWidget::insertGraphRevisions(int firstRow, int count)
+{
+   mRepositoryModel->onRevisionsInserted(firstRow, count);
+}
+
+void HistoryWidget::appendGraphPage(int totalCommits, bool moreRevisions)
+{
+   mRepositoryModel->onRevisionsAppended(totalCommits);
+   mRepositoryModel->setMoreRevisions(moreRevisions);
+}
+
+void HistoryWidget::setMoreGraphRevisions(bool moreRevisions)
+{
+   mRepositoryModel->setMoreRevisions(moreRevisions);
+}
+
+void HistoryWidget::updateGraphMetadata(int firstRow, int lastRow)
+{
+   mRepositoryModel->onMetadataLoaded(firstRow, lastRow);
+}
+
 void HistoryWidget::keyPressEvent(QKeyEvent *event)
 {
    if (event->key() == Qt::Key_Shift)
@@ -409,23 +485,27 @@ void HistoryWidget::onDiffFontSizeChanged()
 
 void HistoryWidget::search()
 {
+   mSearchTimer->stop();
+   mSearchPending = false;
+
+   if (mChContentSearch->isChecked())
+   {
+      startContentSearch();
+      return;
+   }
+
    if (const auto text = mSearchInput->text(); !text.isEmpty())
    {
+      // The commits that were never shown don't have their message yet: searching reads the rest of the history.
+      mCache->requestSearchMetadata();
+
       auto commitInfo = mCache->commitInfo(text);
 
       if (commitInfo.isValid())
          goToSha(text);
       else
       {
-         auto selectedItems = mRepositoryView->selectedIndexes();
-         auto startingRow = 0;
-
-         if (!selectedItems.isEmpty())
-         {
-            std::sort(selectedItems.begin(), selectedItems.end(),
-                      [](const QModelIndex index1, const QModelIndex index2) { return index1.row() <= index2.row(); });
-            startingRow = selectedItems.constFirst().row();
-         }
+         const auto startingRow = std::max(selectedRow(), 0);
 
          commitInfo = mCache->searchCommitInfo(text, startingRow + 1, mReverseSearch);
 
@@ -437,6 +517,76 @@ void HistoryWidget::search()
    }
 }
 
+void HistoryWidget::searchAsYouType()
+{
+   const auto text = mSearchInput->text();
+
+   mSearchPending = false;
+
+   // Shorter texts match almost every commit, so the view would only jump around while the user types.
+   if (text.size() < MIN_SEARCH_SIZE || mChContentSearch->isChecked())
+      return;
+
+   mCache->requestSearchMetadata();
+
+   // The search starts at the selected commit so it stays selected while it keeps matching. Scanning the history on
+   // every key would block the UI, so while the index catches up with the cache the search waits for it.
+   CommitInfo commit;
+
+   if (!mCache->searchIndexedCommitInfo(text, std::max(selectedRow(), 0), &commit))
+   {
+      mSearchPending = true;
+      return;
+   }
+
+   if (commit.isValid() && commit.sha != mCommitInfoWidget->getCurrentCommitSha())
+      goToSha(commit.sha);
+}
+
+void HistoryWidget::startContentSearch()
+{
+   const auto text = mSearchInput->text();
+
+   if (text.isEmpty())
+   {
+      stopContentSearch();
+      return;
+   }
+
+   // The view is emptied and then filled while git finds the commits.
+   mRepositoryView->filterBySha({});
+
+   mContentSearchStatus->setText(tr("Searching..."));
+   mContentSearchStatus->setVisible(true);
+
+   mContentSearch->start(text, mChShowAllBranches->isChecked());
+}
+
+void HistoryWidget::stopContentSearch()
+{
+   mContentSearch->cancel();
+   mContentSearchStatus->setVisible(false);
+
+   if (mRepositoryView->hasActiveFilter())
+   {
+      mRepositoryView->clearFilter();
+      mRepositoryView->focusOnCommit(mCommitInfoWidget->getCurrentCommitSha());
+   }
+}
+
+int HistoryWidget::selectedRow() const
+{
+   auto selectedItems = mRepositoryView->selectedIndexes();
+
+   if (selectedItems.isEmpty())
+      return -1;
+
+   std::sort(selectedItems.begin(), selectedItems.end(),
+             [](const QModelIndex index1, const QModelIndex index2) { return index1.row() <= index2.row(); });
+
+   return selectedItems.constFirst().row();
+}
+
 void HistoryWidget::goToSha(const QString &sha)
 {
    mRepositoryView->focusOnCommit(sha);
@@ -446,9 +596,46 @@ void HistoryWidget::goToSha(const QString &sha)
 
 void HistoryWidget::commitSelected(const QModelIndex &index)
 {
-   const auto sha = mRepositoryModel->sha(index.row());
+   // The index can belong to the filter of the content search, so the SHA is read through its own model.
+   const auto sha = index.sibling(index.row(), static_cast<int>(CommitHistoryColumns::Sha)).data().toString();
 
    selectCommit(sha);
+
+   if (index.isValid())
+      prefetchRevisionFiles(index.row());
+}
+
+void HistoryWidget::prefetchRevisionFiles(int row)
+{
+   const auto model = mRepositoryView->model();
+   const auto shaColumn = static_cast<int>(CommitHistoryColumns::Sha);
+   QVector<RevisionFilesPrefetcher::Key> keys;
+
+   // The closest commits go first, alternating below and above the selected one.
+   for (auto distance = 1; distance <= RevisionFilesPrefetcher::DEFAULT_RANGE; ++distance)
+   {
+      for (const auto neighbour : { row + distance, row - distance })
+      {
+         if (neighbour < 0 || neighbour >= model->rowCount())
+            continue;
+
+         const auto sha = model->index(neighbour, shaColumn).data().toString();
+
+         if (sha.isEmpty() || sha == ZERO_SHA)
+            continue;
+
+         if (const auto parent = mCache->commitInfo(sha).firstParent();
+             !parent.isEmpty() && !mCache->hasRevisionFiles(sha, parent))
+         {
+            keys.append(qMakePair(sha, parent));
+         }
+      }
+   }
+
+   if (keys.isEmpty())
+      mPrefetcher->cancel();
+   else
+      mPrefetcher->prefetch(keys);
 }
 
 void HistoryWidget::onShowAllUpdated(bool showAll)
@@ -44,6 +44,9 @@ class IGitServerCache;
 class QLabel;
 class GitQlientSettings;
 class QSplitter;
+class QTimer;
+class ContentSearch;
+class RevisionFilesPrefetcher;
 struct GitExecResult;
 
 /*!
@@ -71,6 +74,11 @@ signals:
 
    void logReload();
 
+   /*!
+    \brief Signal triggered when the graph view is scrolled to the end and the next page of revisions has to be loaded.
+   */
+   void loadMoreRevisions();
+
    /**
     * @brief Signal triggered when the user wants to see the diff of the selected SHA compared to its first parent.
     * @param sha The selected commit SHA.
@@ -206,6 +214,44 @@ public:
     \param totalCommits The new total of commits to show in the graph.
    */
    void updateGraphView(int totalCommits);
+   /*!
+    \brief Adds to the history model of the repository graph view the revisions loaded so far, while the loading process
+    is still running.
+
+    \param totalCommits The total of commits loaded so far.
+   */
+   void appendGraphRevisions(int totalCommits);
+
+   /*!
+    \brief Adds to the history model of the repository graph view the revisions that an incremental refresh inserted.
+
+    \param firstRow The first row that was inserted.
+    \param count The number of revisions inserted.
+   */
+   void insertGraphRevisions(int firstRow, int count);
+
+   /*!
+    \brief Refreshes the rows of the repository graph view once the author and message of their revisions are read.
+
+    \param firstRow The first row updated.
+    \param lastRow The last row updated.
+   */
+   void updateGraphMetadata(int firstRow, int lastRow);
+
+   /*!
+    \brief Adds to the history model of the repository graph view the page of revisions loaded at the end.
+
+    \param totalCommits The total of commits loaded so far.
+    \param moreRevisions Whether there are more revisions to load after them.
+   */
+   void appendGraphPage(int totalCommits, bool moreRevisions);
+
+   /*!
+    \brief Sets if there are more revisions to load when the graph view is scrolled to the end.
+
+    \param moreRevisions Whether there are more revisions to load.
+   */
+   void setMoreGraphRevisions(bool moreRevisions);
 
    /**
     * @brief onCommitTitleMaxLenghtChanged Changes the maximum length of the commit title.
@@ -242,12 +288,17 @@ private:
    CommitHistoryView *mRepositoryView = nullptr;
    BranchesWidget *mBranchesWidget = nullptr;
    QLineEdit *mSearchInput = nullptr;
+   QTimer *mSearchTimer = nullptr;
+   bool mSearchPending = false;
    QStackedWidget *mCommitStackedWidget = nullptr;
    QStackedWidget *mCenterStackedWidget = nullptr;
    CommitChangesWidget *mWipWidget = nullptr;
    CommitChangesWidget *mAmendWidget = nullptr;
    CommitInfoWidget *mCommitInfoWidget = nullptr;
    CheckBox *mChShowAllBranches = nullptr;
+   CheckBox *mChContentSearch = nullptr;
+   ContentSearch *mContentSearch = nullptr;
+   QLabel *mContentSearchStatus = nullptr;
    RepositoryViewDelegate *mItemDelegate = nullptr;
    QFrame *mGraphFrame = nullptr;
    FileDiffWidget *mWipFileDiff = nullptr;
@@ -257,12 +308,31 @@ private:
    QLabel *mUserEmail = nullptr;
    bool mReverseSearch = false;
    QSplitter *mSplitter = nullptr;
+   RevisionFilesPrefetcher *mPrefetcher = nullptr;
 
    /*!
     \brief Performs a search based on the input of the search QLineEdit with the users input.
 
    */
    void search();
+   /*!
+    \brief Goes to the first commit that matches the text of the search QLineEdit while the user types, starting at the
+    selected one. Nothing happens if no commit matches.
+   */
+   void searchAsYouType();
+   /*!
+    \brief Returns the first selected row of the repository graph view, or -1 if none is selected.
+   */
+   int selectedRow() const;
+   /*!
+    \brief Starts searching the text of the search QLineEdit in the changes of the commits. The graph view only shows
+    the commits found, and they are added while git finds them.
+   */
+   void startContentSearch();
+   /*!
+    \brief Cancels the search in the changes and shows all the commits again.
+   */
+   void stopContentSearch();
    /*!
     \brief Goes to the selected SHA.
 
@@ -276,6 +346,13 @@ private:
     \param index The index from the model.
    */
    void commitSelected(const QModelIndex &index);
+   /*!
+    \brief Loads in the background the files changed by the commits around the selected one, so moving through the
+    history doesn't wait for git.
+
+    \param row The row of the selected commit in the view.
+   */
+   void prefetchRevisionFiles(int row);
    /*!
     \brief Action that stores in the settings the new value for the check box to show all the branches. It also triggers
     the \ref signalAllBranchesActive signal.
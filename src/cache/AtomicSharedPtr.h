@@ -0,0 +1,69 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief The AtomicSharedPtr class holds a shared pointer that can be read and replaced from different threads without
+ * a mutex. It's used to publish immutable versions of the data: the readers keep the version they loaded alive for as
+ * long as they use it, while the writer stores the next one.
+ *
+ * It uses std::atomic<std::shared_ptr> when the standard library has it and the atomic functions of std::shared_ptr
+ * otherwise.
+ */
+template<typename T>
+class AtomicSharedPtr
+{
+public:
+   explicit AtomicSharedPtr(std::shared_ptr<T> value)
+      : mValue(std::move(value))
+   {
+   }
+
+   AtomicSharedPtr(const AtomicSharedPtr &) = delete;
+   AtomicSharedPtr &operator=(const AtomicSharedPtr &) = delete;
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+   std::shared_ptr<T> load() const { return mValue.load(std::memory_order_acquire); }
+   void store(std::shared_ptr<T> value) { mValue.store(std::move(value), std::memory_order_release); }
+
+private:
+   std::atomic<std::shared_ptr<T>> mValue;
+#else
+   // The functions are deprecated in C++20 in favour of std::atomic<std::shared_ptr>, which is used when available.
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+   std::shared_ptr<T> load() const { return std::atomic_load_explicit(&mValue, std::memory_order_acquire); }
+   void store(std::shared_ptr<T> value)
+   {
+      std::atomic_store_explicit(&mValue, std::move(value), std::memory_order_release);
+   }
+#   pragma GCC diagnostic pop
+
+private:
+   std::shared_ptr<T> mValue;
+#endif
+};
@@ -1,19 +1,40 @@
 INCLUDEPATH += $$PWD
 
 HEADERS += \
+    $$PWD/AtomicSharedPtr.h \
+    $$PWD/CommitGraphReader.h \
     $$PWD/CommitInfo.h \
+    $$PWD/CommitObjectReader.h \
+    $$PWD/CommitSearchIndex.h \
+    $$PWD/CommitTable.h \
     $$PWD/GitCache.h \
     $$PWD/GitRepoLoader.h \
     $$PWD/Lane.h \
+    $$PWD/LaneLayout.h \
     $$PWD/LaneType.h \
+    $$PWD/Oid.h \
+    $$PWD/ReferenceIndex.h \
     $$PWD/References.h \
+    $$PWD/ReferencesReader.h \
+    $$PWD/RevisionFilesCache.h \
+    $$PWD/RevisionFilesPrefetcher.h \
     $$PWD/WipHelper.h \
     $$PWD/lanes.h
 
 SOURCES += \
+    $$PWD/CommitGraphReader.cpp \
     $$PWD/CommitInfo.cpp \
+    $$PWD/CommitObjectReader.cpp \
+    $$PWD/CommitSearchIndex.cpp \
+    $$PWD/CommitTable.cpp \
     $$PWD/GitCache.cpp \
     $$PWD/GitRepoLoader.cpp \
     $$PWD/Lane.cpp \
+    $$PWD/LaneLayout.cpp \
+    $$PWD/Oid.cpp \
+    $$PWD/ReferenceIndex.cpp \
     $$PWD/References.cpp \
+    $$PWD/ReferencesReader.cpp \
+    $$PWD/RevisionFilesCache.cpp \
+    $$PWD/RevisionFilesPrefetcher.cpp \
     $$PWD/lanes.cpp
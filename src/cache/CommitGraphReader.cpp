@@ -0,0 +1,407 @@
+#include "CommitGraphReader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace
+{
+const int HEADER_SIZE = 8;
+const int CHUNK_ENTRY_SIZE = 12;
+const int OID_SIZE = 20;
+const int COMMIT_DATA_SIZE = OID_SIZE + 16;
+const quint32 CHUNK_FANOUT = 0x4f494446; // "OIDF"
+const quint32 CHUNK_OID_LOOKUP = 0x4f49444c; // "OIDL"
+const quint32 CHUNK_COMMIT_DATA = 0x43444154; // "CDAT"
+const quint32 CHUNK_EXTRA_EDGES = 0x45444745; // "EDGE"
+const quint32 PARENT_NONE = 0x70000000;
+const quint32 EXTRA_EDGES_NEEDED = 0x80000000;
+const quint32 LAST_EDGE = 0x80000000;
+const quint32 EDGE_MASK = 0x7fffffff;
+
+quint32 readUInt32(const uchar *data)
+{
+   return qFromBigEndian<quint32>(data);
+}
+
+quint64 readUInt64(const uchar *data)
+{
+   return qFromBigEndian<quint64>(data);
+}
+
+struct QueuedCommit
+{
+   qint64 date = 0;
+   qint64 insertion = 0;
+   int position = -1;
+
+   // The newest commit goes first and the commits with the same date keep the order they were queued in.
+   bool operator<(const QueuedCommit &other) const
+   {
+      return date != other.date ? date < other.date : insertion > other.insertion;
+   }
+};
+}
+
+CommitGraphReader::CommitGraphReader(const QString &gitDir)
+{
+   auto commonDir = gitDir;
+
+   // The worktrees share the object database of the main repository.
+   if (QFile file(QString("%1/commondir").arg(gitDir)); file.open(QIODevice::ReadOnly))
+   {
+      if (const auto dir = QString::fromUtf8(file.readAll()).trimmed(); !dir.isEmpty())
+         commonDir = QDir(gitDir).absoluteFilePath(dir);
+   }
+
+   mObjectsDir = QString("%1/objects").arg(commonDir);
+}
+
+CommitGraphReader::~CommitGraphReader() = default;
+
+bool CommitGraphReader::open()
+{
+   mLayers.clear();
+   mTotal = 0;
+
+   // Git doesn't trust the commit-graph when the history is altered by grafts or a shallow clone, and neither do we.
+   if (QFile::exists(QString("%1/info/grafts").arg(mObjectsDir))
+       || QFile::exists(QString("%1/../shallow").arg(mObjectsDir)))
+   {
+      return false;
+   }
+
+   // Like git, the single commit-graph file takes precedence over the chain of split graphs.
+   if (openLayer(QString("%1/info/commit-graph").arg(mObjectsDir)))
+      return true;
+
+   QFile chain(QString("%1/info/commit-graphs/commit-graph-chain").arg(mObjectsDir));
+
+   if (!chain.open(QIODevice::ReadOnly))
+      return false;
+
+   // The chain lists the graphs from the base to the top, and every layer refers to the commits of the ones below.
+   const auto hashes = chain.readAll().split('\n');
+
+   for (const auto &hash : hashes)
+   {
+      if (const auto graph = QString::fromUtf8(hash.trimmed()); !graph.isEmpty()
+          && !openLayer(QString("%1/info/commit-graphs/graph-%2.graph").arg(mObjectsDir, graph)))
+      {
+         mLayers.clear();
+         mTotal = 0;
+
+         return false;
+      }
+   }
+
+   return !mLayers.empty();
+}
+
+bool CommitGraphReader::openLayer(const QString &fileName)
+{
+   Layer layer;
+   layer.file = std::make_unique<QFile>(fileName);
+
+   if (!layer.file->open(QIODevice::ReadOnly))
+      return false;
+
+   const auto size = layer.file->size();
+
+   if (size < HEADER_SIZE + CHUNK_ENTRY_SIZE)
+      return false;
+
+   const auto data = layer.file->map(0, size);
+
+   if (!data)
+      return false;
+
+   layer.data = data;
+
+   // Only the version 1 with SHA-1 ids is supported. The layer must also be the next one of the chain.
+   if (std::memcmp(data, "CGPH", 4) != 0 || data[4] != 1 || data[5] != 1 || static_cast<size_t>(data[7]) != mLayers.size())
+      return false;
+
+   const auto chunks = static_cast<int>(data[6]);
+
+   if (HEADER_SIZE + (chunks + 1) * CHUNK_ENTRY_SIZE > size)
+      return false;
+
+   quint64 oidsSize = 0;
+   quint64 commitsSize = 0;
+
+   for (auto i = 0; i < chunks; ++i)
+   {
+      const auto entry = data + HEADER_SIZE + i * CHUNK_ENTRY_SIZE;
+      const auto offset = readUInt64(entry + 4);
+      const auto end = readUInt64(entry + CHUNK_ENTRY_SIZE + 4);
+
+      if (offset > end || end > static_cast<quint64>(size))
+         return false;
+
+      const auto chunk = data + offset;
+      const auto chunkSize = end - offset;
+
+      switch (readUInt32(entry))
+      {
+         case CHUNK_FANOUT:
+            if (chunkSize != 256 * 4)
+               return false;
+
+            layer.fanout = chunk;
+            break;
+         case CHUNK_OID_LOOKUP:
+            layer.oids = chunk;
+            oidsSize = chunkSize;
+            break;
+         case CHUNK_COMMIT_DATA:
+            layer.commits = chunk;
+            commitsSize = chunkSize;
+            break;
+         case CHUNK_EXTRA_EDGES:
+            layer.edges = chunk;
+            layer.edgesCount = static_cast<qint64>(chunkSize / 4);
+            break;
+         default:
+            break;
+      }
+   }
+
+   if (!layer.fanout || !layer.oids || !layer.commits)
+      return false;
+
+   const auto count = readUInt32(layer.fanout + 255 * 4);
+
+   if (count > static_cast<quint32>(std::numeric_limits<int>::max() - mTotal) || oidsSize != count * quint64(OID_SIZE)
+       || commitsSize != count * quint64(COMMIT_DATA_SIZE))
+   {
+      return false;
+   }
+
+   layer.first = mTotal;
+   layer.count = static_cast<int>(count);
+   mTotal += layer.count;
+
+   mLayers.push_back(std::move(layer));
+
+   return true;
+}
+
+int CommitGraphReader::position(const Oid &oid) const
+{
+   const auto firstByte = oid.bytes.front();
+
+   for (const auto &layer : mLayers)
+   {
+      auto low = firstByte == 0 ? 0U : readUInt32(layer.fanout + (firstByte - 1) * 4);
+      auto high = std::min(readUInt32(layer.fanout + firstByte * 4), static_cast<quint32>(layer.count));
+
+      while (low < high)
+      {
+         const auto middle = low + (high - low) / 2;
+         const auto cmp = std::memcmp(layer.oids + middle * OID_SIZE, oid.bytes.data(), OID_SIZE);
+
+         if (cmp == 0)
+            return layer.first + static_cast<int>(middle);
+
+         if (cmp < 0)
+            low = middle + 1;
+         else
+            high = middle;
+      }
+   }
+
+   return -1;
+}
+
+QVector<CommitInfo> CommitGraphReader::log(const QVector<int> &tips, Order order, bool *ok) const
+{
+   *ok = false;
+
+   // As git does, every commit in the history starts with an in-degree of 1 and gets one more for each child, so the
+   // commit can be shown when it's back to 1.
+   QVector<int> indegree(mTotal, 0);
+   QVector<int> pending;
+   QVector<int> startingTips;
+   QVarLengthArray<int, 2> commitParents;
+
+   for (const auto tip : tips)
+   {
+      if (tip < 0 || tip >= mTotal)
+         return {};
+
+      if (indegree.at(tip) == 0)
+      {
+         indegree[tip] = 1;
+         pending.append(tip);
+         startingTips.append(tip);
+      }
+   }
+
+   auto total = 0;
+
+   while (!pending.isEmpty())
+   {
+      const auto position = pending.takeLast();
+      ++total;
+
+      if (!parents(position, commitParents))
+         return {};
+
+      for (const auto parent : std::as_const(commitParents))
+      {
+         if (indegree.at(parent) == 0)
+         {
+            indegree[parent] = 1;
+            pending.append(parent);
+         }
+
+         ++indegree[parent];
+      }
+   }
+
+   // The tips are taken from the newest to the oldest, and the ones reachable from other tips wait for their children.
+   std::stable_sort(startingTips.begin(), startingTips.end(),
+                    [this](int tip, int other) { return commitDate(tip) > commitDate(other); });
+   startingTips.erase(std::remove_if(startingTips.begin(), startingTips.end(),
+                                     [&indegree](int tip) { return indegree.at(tip) != 1; }),
+                      startingTips.end());
+
+   // With --date-order the newest commit whose children have been shown goes next. With --topo-order the last commit
+   // that became ready goes next, so the lines of development are not interleaved.
+   std::priority_queue<QueuedCommit> byDate;
+   QVector<int> byTopology;
+   qint64 insertion = 0;
+
+   const auto push = [&](int position) {
+      if (order == Order::Date)
+         byDate.push({ commitDate(position), insertion++, position });
+      else
+         byTopology.append(position);
+   };
+
+   if (order == Order::Date)
+   {
+      for (const auto tip : std::as_const(startingTips))
+         push(tip);
+   }
+   else
+   {
+      for (auto i = startingTips.count() - 1; i >= 0; --i)
+         push(startingTips.at(i));
+   }
+
+   QVector<CommitInfo> commits;
+   commits.reserve(total);
+
+   while (!byDate.empty() || !byTopology.isEmpty())
+   {
+      int position;
+
+      if (order == Order::Date)
+      {
+         position = byDate.top().position;
+         byDate.pop();
+      }
+      else
+         position = byTopology.takeLast();
+
+      parents(position, commitParents);
+
+      QStringList parentShas;
+      parentShas.reserve(commitParents.count());
+
+      for (const auto parent : std::as_const(commitParents))
+      {
+         parentShas.append(oid(parent).toString());
+
+         if (--indegree[parent] == 1)
+            push(parent);
+      }
+
+      commits.append(CommitInfo(oid(position).toString(), parentShas, std::chrono::seconds(commitDate(position)),
+                                QString()));
+   }
+
+   *ok = commits.count() == total;
+
+   return commits;
+}
+
+const CommitGraphReader::Layer &CommitGraphReader::layer(int position) const
+{
+   const auto found = std::find_if(mLayers.cbegin(), mLayers.cend(), [position](const Layer &graph) {
+      return position < graph.first + graph.count;
+   });
+
+   return *found;
+}
+
+Oid CommitGraphReader::oid(int position) const
+{
+   const auto &graph = layer(position);
+
+   Oid oid;
+   std::memcpy(oid.bytes.data(), graph.oids + static_cast<qint64>(position - graph.first) * OID_SIZE, OID_SIZE);
+
+   return oid;
+}
+
+qint64 CommitGraphReader::commitDate(int position) const
+{
+   const auto &graph = layer(position);
+   const auto data = graph.commits + static_cast<qint64>(position - graph.first) * COMMIT_DATA_SIZE;
+
+   // The two lowest bits of the generation word are the 33rd and 34th bits of the date.
+   return (static_cast<qint64>(readUInt32(data + OID_SIZE + 8) & 0x3) << 32) | readUInt32(data + OID_SIZE + 12);
+}
+
+bool CommitGraphReader::parents(int position, QVarLengthArray<int, 2> &parents) const
+{
+   parents.clear();
+
+   const auto &graph = layer(position);
+   const auto data = graph.commits + static_cast<qint64>(position - graph.first) * COMMIT_DATA_SIZE;
+   const auto append = [this, &parents](quint32 parent) {
+      if (parent >= static_cast<quint32>(mTotal))
+         return false;
+
+      parents.append(static_cast<int>(parent));
+      return true;
+   };
+
+   const auto first = readUInt32(data + OID_SIZE);
+   const auto second = readUInt32(data + OID_SIZE + 4);
+
+   if (first == PARENT_NONE)
+      return true;
+
+   if (!append(first))
+      return false;
+
+   if (second == PARENT_NONE)
+      return true;
+
+   if (!(second & EXTRA_EDGES_NEEDED))
+      return append(second);
+
+   // The octopus merges keep the rest of their parents in the extra edges list, the last one flagged.
+   for (auto edge = static_cast<qint64>(second & EDGE_MASK); edge < graph.edgesCount; ++edge)
+   {
+      const auto value = readUInt32(graph.edges + edge * 4);
+
+      if (!append(value & EDGE_MASK))
+         return false;
+
+      if (value & LAST_EDGE)
+         return true;
+   }
+
+   return false;
+}
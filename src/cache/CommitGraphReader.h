@@ -0,0 +1,110 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <CommitInfo.h>
+#include <Oid.h>
+
+#include <QString>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+class QFile;
+
+/**
+ * @brief The CommitGraphReader class reads the topology of the history from the commit-graph file that git writes in
+ * objects/info (or from the chain of split graphs in objects/info/commit-graphs). The files are mapped in memory and
+ * give, for every commit, its SHA, its parents and its commit date without starting git or parsing any text.
+ *
+ * The commit-graph doesn't store the author nor the message of the commits: the commits built from it have only the
+ * topology and the date, and the rest of their data has to be read from git when it's needed.
+ */
+class CommitGraphReader
+{
+public:
+   enum class Order
+   {
+      Date,
+      Topological
+   };
+
+   explicit CommitGraphReader(const QString &gitDir);
+   ~CommitGraphReader();
+
+   /**
+    * @brief Maps the commit-graph files of the repository.
+    *
+    * @return True if there is a commit-graph that can be read, false otherwise.
+    */
+   bool open();
+
+   int count() const { return mTotal; }
+
+   /**
+    * @brief Looks up a commit in the graph.
+    *
+    * @param oid The id of the commit.
+    * @return The position of the commit in the graph or -1 if the graph doesn't contain it.
+    */
+   int position(const Oid &oid) const;
+
+   /**
+    * @brief Builds the commits reachable from @p tips in the same order git log shows them with --date-order or
+    * --topo-order. The commits only have the SHA, the parents and the commit date.
+    *
+    * @param tips The positions of the commits to start from.
+    * @param order The order of the commits.
+    * @param ok Set to false when the graph is corrupted.
+    * @return The commits.
+    */
+   QVector<CommitInfo> log(const QVector<int> &tips, Order order, bool *ok) const;
+
+private:
+   struct Layer
+   {
+      std::unique_ptr<QFile> file;
+      const uchar *data = nullptr;
+      const uchar *fanout = nullptr;
+      const uchar *oids = nullptr;
+      const uchar *commits = nullptr;
+      const uchar *edges = nullptr;
+      qint64 edgesCount = 0;
+      int first = 0;
+      int count = 0;
+   };
+
+   QString mObjectsDir;
+   std::vector<Layer> mLayers;
+   int mTotal = 0;
+
+   bool openLayer(const QString &fileName);
+   const Layer &layer(int position) const;
+   Oid oid(int position) const;
+   qint64 commitDate(int position) const;
+   bool parents(int position, QVarLengthArray<int, 2> &parents) const;
+};
@@ -1,10 +1,12 @@
 #include "CommitInfo.h"
 
 #include <GitExecResult.h>
+#include <Oid.h>
 
 #include <QStringList>
 
-#include <regex>
+#include <algorithm>
+#include <array>
 
 CommitInfo::CommitInfo(QByteArray commitData, const QString &gpg, bool goodSignature)
    : gpgKey(gpg)
@@ -18,36 +20,47 @@ CommitInfo::CommitInfo(QByteArray data)
    parseDiff(data, 1);
 }
 
-void CommitInfo::parseDiff(QByteArray &data, qsizetype startingField)
+void CommitInfo::parseDiff(const QByteArray &data, qsizetype startingField)
 {
    if (data.isEmpty())
       return;
 
-   if (const auto fields = QString::fromUtf8(data).split('\n'); fields.count() > 0)
-   {
-      auto combinedShas = fields.at(startingField++);
-      auto shas = combinedShas.split('X');
-      auto first = shas.takeFirst();
-      sha = first.remove(0, 1);
+   qsizetype start = 0;
 
-      if (!shas.isEmpty())
-      {
+   const auto nextField = [&data, &start]() {
+      auto end = data.indexOf('\n', start);
+
+      if (end == -1)
+         end = data.size();
+
+      const auto field = QString::fromUtf8(data.constData() + start, end - start);
+      start = std::min(end + 1, data.size());
+
+      return field;
+   };
+
+   for (auto i = 0; i < startingField; ++i)
+      nextField();
+
+   const auto combinedShas = nextField();
+
+   if (const auto separator = combinedShas.indexOf('X'); separator != -1)
+   {
+      sha = combinedShas.mid(1, separator - 1);
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-         mParentsSha = shas.takeFirst().split(' ', Qt::SkipEmptyParts);
+      mParentsSha = combinedShas.mid(separator + 1).split(' ', Qt::SkipEmptyParts);
 #else
-         mParentsSha = shas.takeFirst().split(' ', QString::SkipEmptyParts);
+      mParentsSha = combinedShas.mid(separator + 1).split(' ', QString::SkipEmptyParts);
 #endif
-      }
-      committer = fields.at(startingField++);
-      author = fields.at(startingField++);
-      dateSinceEpoch = std::chrono::seconds(fields.at(startingField++).toInt());
-      shortLog = fields.at(startingField++);
-
-      for (auto i = startingField; i < fields.count(); ++i)
-         longLog += fields.at(i) + '\n';
-
-      longLog = longLog.trimmed();
    }
+   else
+      sha = combinedShas.mid(1);
+
+   committer = nextField();
+   author = nextField();
+   dateSinceEpoch = std::chrono::seconds(nextField().toInt());
+   shortLog = nextField();
+   longLog = QString::fromUtf8(data.constData() + start, data.size() - start).trimmed();
 }
 
 CommitInfo::CommitInfo(const QString &sha, const QStringList &parents, std::chrono::seconds commitDate,
@@ -61,9 +74,12 @@ CommitInfo::CommitInfo(const QString &sha, const QStringList &parents, std::chro
 
 bool CommitInfo::operator==(const CommitInfo &commit) const
 {
-   return sha.startsWith(commit.sha) && mParentsSha == commit.mParentsSha && committer == commit.committer
+   const auto sameSha = sha.size() == commit.sha.size() ? sha == commit.sha
+                                                        : OidPrefix::fromString(commit.sha).matches(Oid::fromString(sha));
+
+   return sameSha && mParentsSha == commit.mParentsSha && committer == commit.committer
        && author == commit.author && dateSinceEpoch == commit.dateSinceEpoch && shortLog == commit.shortLog
-       && longLog == commit.longLog && mLanes == commit.mLanes;
+       && longLog == commit.longLog;
 }
 
 bool CommitInfo::operator!=(const CommitInfo &commit) const
@@ -104,55 +120,43 @@ void CommitInfo::setParents(const QStringList &parents)
 
 bool CommitInfo::isInWorkingBranch() const
 {
-   for (const auto &child : mChilds)
-   {
-      if (child->sha == ZERO_SHA)
-      {
-         return true;
-         break;
-      }
-   }
-
-   return false;
-}
-
-void CommitInfo::setLanes(QVector<Lane> lanes)
-{
-   this->mLanes.clear();
-   this->mLanes.squeeze();
-   this->mLanes = std::move(lanes);
+   return mChilds.contains(ZERO_SHA);
 }
 
 bool CommitInfo::isValid() const
 {
-   const static std::regex hexMatcher("[0-9a-fA-F]{40}");
-   const auto isMatch = std::regex_match(sha.toStdString(), hexMatcher);
+   // Zero for the hexadecimal digits, so the SHA is validated by accumulating the table values without branching.
+   static const auto nonHexChars = []() {
+      std::array<uchar, 128> table;
+      table.fill(1);
 
-   return !sha.isEmpty() && isMatch;
-}
+      for (auto c = '0'; c <= '9'; ++c)
+         table[static_cast<uchar>(c)] = 0;
 
-int CommitInfo::getActiveLane() const
-{
-   auto i = 0;
+      for (auto c = 'a'; c <= 'f'; ++c)
+      {
+         table[static_cast<uchar>(c)] = 0;
+         table[static_cast<uchar>(c - 'a' + 'A')] = 0;
+      }
+
+      return table;
+   }();
+
+   if (sha.size() != 40)
+      return false;
 
-   for (auto lane : mLanes)
+   auto invalid = 0U;
+
+   for (const auto character : sha)
    {
-      if (lane.isActive())
-         return i;
-      else
-         ++i;
+      const auto value = character.unicode();
+      invalid |= (value >> 7) | nonHexChars[value & 0x7F];
    }
 
-   return -1;
-}
-
-void CommitInfo::removeChild(CommitInfo *commit)
-{
-   if (mChilds.contains(commit))
-      mChilds.removeAll(commit);
+   return invalid == 0;
 }
 
 QString CommitInfo::getFirstChildSha() const
 {
-   return !mChilds.isEmpty() ? mChilds.constFirst()->sha : QString {};
+   return !mChilds.isEmpty() ? mChilds.constFirst() : QString {};
 }
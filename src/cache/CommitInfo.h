@@ -29,7 +29,6 @@
 
 #include <chrono>
 
-#include <Lane.h>
 #include <References.h>
 
 class CommitInfo
@@ -64,14 +63,6 @@ public:
    void setParents(const QStringList &parents);
    bool isInWorkingBranch() const;
 
-   void setLanes(QVector<Lane> lanes);
-   QVector<Lane> lanes() const { return mLanes; }
-   int lanesCount() const { return mLanes.count(); }
-   Lane laneAt(int i) const { return mLanes.at(i); }
-   int getActiveLane() const;
-
-   void appendChild(CommitInfo *commit) { mChilds.append(commit); }
-   void removeChild(CommitInfo *commit);
    bool hasChilds() const { return !mChilds.empty(); }
    QString getFirstChildSha() const;
    int getChildsCount() const { return mChilds.count(); }
@@ -90,11 +81,11 @@ public:
 
 private:
    bool mGoodSignature = false;
-   QVector<Lane> mLanes;
    QStringList mParentsSha;
-   QVector<CommitInfo *> mChilds;
+   QStringList mChilds;
 
    friend class GitCache;
+   friend class CommitTable;
 
-   void parseDiff(QByteArray &data, qsizetype startingField);
+   void parseDiff(const QByteArray &data, qsizetype startingField);
 };
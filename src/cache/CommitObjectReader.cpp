@@ -0,0 +1,242 @@
+#include "CommitObjectReader.h"
+
+#include <QLogger.h>
+
+#include <QtGlobal>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#   include <QStringDecoder>
+#else
+#   include <QTextCodec>
+#endif
+
+#include <utility>
+
+using namespace QLogger;
+
+namespace
+{
+/**
+ * @brief Decodes the text of a commit object written in @p encoding, the value of its encoding header. As git log
+ * does, the commits without the header and the encodings that are not known are read as UTF-8.
+ */
+QString decode(const QByteArray &text, const QByteArray &encoding)
+{
+   if (!encoding.isEmpty())
+   {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+      if (QStringDecoder decoder(encoding.constData()); decoder.isValid())
+         return decoder.decode(text);
+#else
+      if (const auto codec = QTextCodec::codecForName(encoding))
+         return codec->toUnicode(text);
+#endif
+   }
+
+   return QString::fromUtf8(text);
+}
+
+/**
+ * @brief Splits an identity line of a commit object ("Name <email> timestamp timezone") into the identity in the
+ * format used by the log ("Name<email>") and its timestamp.
+ */
+QString parseIdentity(const QByteArray &line, const QByteArray &encoding, qint64 *timestamp = nullptr)
+{
+   const auto emailEnd = line.lastIndexOf('>');
+
+   if (emailEnd == -1)
+      return decode(line, encoding);
+
+   if (timestamp)
+      *timestamp = line.mid(emailEnd + 1).trimmed().split(' ').constFirst().toLongLong();
+
+   const auto emailStart = line.lastIndexOf('<', emailEnd);
+
+   if (emailStart == -1)
+      return decode(line.left(emailEnd + 1), encoding);
+
+   return decode(line.left(emailStart).trimmed(), encoding)
+       + decode(line.mid(emailStart, emailEnd - emailStart + 1), encoding);
+}
+
+/**
+ * @brief Parses a raw commit object into the same fields the log format of GitRepoLoader gives.
+ */
+CommitInfo parseCommitObject(const QString &sha, const QByteArray &object)
+{
+   QStringList parents;
+   QByteArray committer;
+   QByteArray author;
+   QByteArray encoding;
+
+   // The headers end at the first empty line. The continuation lines of the multi-line headers start with a space.
+   auto messageStart = object.indexOf("\n\n");
+
+   if (messageStart == -1)
+      messageStart = object.size();
+
+   const auto headers = object.left(messageStart).split('\n');
+
+   for (const auto &header : headers)
+   {
+      if (header.startsWith("parent "))
+         parents.append(QString::fromLatin1(header.mid(7)));
+      else if (header.startsWith("author "))
+         author = header.mid(7);
+      else if (header.startsWith("committer "))
+         committer = header.mid(10);
+      else if (header.startsWith("encoding "))
+         encoding = header.mid(9).trimmed();
+   }
+
+   // The date is the author date, the same one the history is loaded with (%at).
+   qint64 authorDate = 0;
+   const auto authorIdentity = parseIdentity(author, encoding, &authorDate);
+
+   // As in git log, the subject is the first paragraph joined in a single line and the body is the rest.
+   const auto message = object.mid(messageStart + 2);
+   auto subjectEnd = message.indexOf("\n\n");
+
+   if (subjectEnd == -1)
+      subjectEnd = message.size();
+
+   CommitInfo commit(sha, parents, std::chrono::seconds(authorDate),
+                     decode(message.left(subjectEnd).trimmed().replace('\n', ' '), encoding));
+   commit.committer = parseIdentity(committer, encoding);
+   commit.author = authorIdentity;
+   commit.longLog = decode(message.mid(subjectEnd), encoding).trimmed();
+
+   return commit;
+}
+}
+
+CommitObjectReader::CommitObjectReader(QObject *parent)
+   : QObject(parent)
+{
+}
+
+CommitObjectReader::~CommitObjectReader()
+{
+   stop();
+}
+
+void CommitObjectReader::read(const QString &workingDir, const QStringList &shas)
+{
+   if (shas.isEmpty())
+      return;
+
+   if (mProcess && mProcess->workingDirectory() != workingDir)
+      stop();
+
+   if (!mProcess)
+   {
+      mProcess = new QProcess(this);
+      mProcess->setWorkingDirectory(workingDir);
+
+      connect(mProcess, &QProcess::readyReadStandardOutput, this, &CommitObjectReader::processOutput);
+      connect(mProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+              &CommitObjectReader::processFinished);
+
+      mProcess->start("git", { "cat-file", "--batch" });
+
+      if (!mProcess->waitForStarted())
+      {
+         QLog_Error("Git", QString("Git couldn't be started to read the commits: %1").arg(mProcess->errorString()));
+
+         delete mProcess;
+         mProcess = nullptr;
+
+         emit commitsRead({});
+         return;
+      }
+   }
+
+   auto input = shas.join('\n').toLatin1();
+   input.append('\n');
+
+   mPending += static_cast<int>(shas.count());
+   mProcess->write(input);
+}
+
+void CommitObjectReader::stop()
+{
+   if (!mProcess)
+      return;
+
+   // The process is detached before it's killed, so its finish is not taken as a crash.
+   mProcess->disconnect(this);
+   mProcess->closeWriteChannel();
+
+   if (!mProcess->waitForFinished(500))
+      mProcess->kill();
+
+   delete mProcess;
+   mProcess = nullptr;
+
+   // The batch in progress is dropped without notifying it: whoever stops the reader doesn't want more reads.
+   mBuffer.clear();
+   mCommits.clear();
+   mPending = 0;
+}
+
+void CommitObjectReader::processOutput()
+{
+   mBuffer.append(mProcess->readAllStandardOutput());
+
+   qsizetype start = 0;
+
+   // Every answer is a "<sha> <type> <size>" line followed by the object and a new line, or "<sha> missing".
+   while (mPending > 0)
+   {
+      const auto headerEnd = mBuffer.indexOf('\n', start);
+
+      if (headerEnd == -1)
+         break;
+
+      const auto header = mBuffer.mid(start, headerEnd - start).split(' ');
+
+      if (header.count() == 3)
+      {
+         const auto size = header.at(2).toLongLong();
+
+         if (mBuffer.size() < headerEnd + 1 + size + 1)
+            break;
+
+         if (header.at(1) == "commit")
+         {
+            mCommits.append(parseCommitObject(QString::fromLatin1(header.at(0)),
+                                              QByteArray::fromRawData(mBuffer.constData() + headerEnd + 1, size)));
+         }
+
+         start = headerEnd + 1 + size + 1;
+      }
+      else
+         start = headerEnd + 1;
+
+      --mPending;
+   }
+
+   mBuffer.remove(0, start);
+
+   if (mPending == 0)
+      finishBatch();
+}
+
+void CommitObjectReader::processFinished()
+{
+   QLog_Warning("Git", "The process that reads the commits finished unexpectedly.");
+
+   mProcess->deleteLater();
+   mProcess = nullptr;
+   mBuffer.clear();
+
+   if (mPending > 0)
+      finishBatch();
+}
+
+void CommitObjectReader::finishBatch()
+{
+   mPending = 0;
+
+   emit commitsRead(std::exchange(mCommits, QVector<CommitInfo>()));
+}
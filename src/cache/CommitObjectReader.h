@@ -0,0 +1,79 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <CommitInfo.h>
+
+#include <QObject>
+#include <QProcess>
+#include <QVector>
+
+/**
+ * @brief The CommitObjectReader class reads the author, committer and message of commits through a git cat-file --batch
+ * process that is kept alive between requests, so every batch of rows shown in the history only costs a write to the
+ * process instead of starting git again.
+ */
+class CommitObjectReader : public QObject
+{
+   Q_OBJECT
+
+signals:
+   /**
+    * @brief Emitted when all the commits of the last read() have been answered. The commits that git couldn't find are
+    * not included.
+    *
+    * @param commits The commits read.
+    */
+   void commitsRead(QVector<CommitInfo> commits);
+
+public:
+   explicit CommitObjectReader(QObject *parent = nullptr);
+   ~CommitObjectReader();
+
+   bool isBusy() const { return mPending > 0; }
+
+   /**
+    * @brief Starts reading the given commits. The process is started the first time, or again if the working directory
+    * changed or it died.
+    *
+    * @param workingDir The working directory of the repository.
+    * @param shas The commits to read.
+    */
+   void read(const QString &workingDir, const QStringList &shas);
+   /**
+    * @brief Stops the process. The batch in progress is dropped and @ref commitsRead is not emitted for it.
+    */
+   void stop();
+
+private:
+   QProcess *mProcess = nullptr;
+   QByteArray mBuffer;
+   QVector<CommitInfo> mCommits;
+   int mPending = 0;
+
+   void processOutput();
+   void processFinished();
+   void finishBatch();
+};
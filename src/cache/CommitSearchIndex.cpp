@@ -0,0 +1,563 @@
+#include "CommitSearchIndex.h"
+
+#include <CommitTable.h>
+
+#include <QLogger.h>
+
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+using namespace QLogger;
+
+namespace
+{
+const int CHUNK_ROWS = 4096;
+const int SHA_BUCKETS = 4096;
+const int MAX_INTERSECTED = 3;
+const int MIN_SCAN_ROWS = 32768; // Smaller parts are not worth a thread.
+
+/**
+ * @brief Returns the sorted and unique trigrams of a case-folded text. Every trigram packs its three UTF-16 units.
+ */
+QVector<quint64> trigrams(const QString &text)
+{
+   QVector<quint64> keys;
+
+   if (text.size() < CommitSearchIndex::MIN_QUERY_SIZE)
+      return keys;
+
+   keys.reserve(text.size() - 2);
+
+   for (auto i = 0; i + 2 < text.size(); ++i)
+   {
+      const auto first = static_cast<quint64>(text.at(i).unicode());
+      const auto second = static_cast<quint64>(text.at(i + 1).unicode());
+      const auto third = static_cast<quint64>(text.at(i + 2).unicode());
+
+      keys.append((first << 32) | (second << 16) | third);
+   }
+
+   std::sort(keys.begin(), keys.end());
+   keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+   return keys;
+}
+
+int shaBucket(const Oid &oid)
+{
+   return (oid.bytes[0] << 4) | (oid.bytes[1] >> 4);
+}
+
+/**
+ * @brief Returns the bucket of the SHAs that start with @p text, or -1 if it doesn't start with three hex digits.
+ */
+int shaBucket(const QString &text)
+{
+   auto ok = false;
+   const auto prefix = OidPrefix::fromString(text.left(3), &ok);
+
+   return ok ? shaBucket(prefix.lowerBound) : -1;
+}
+
+/**
+ * @brief Marks the documents between @p first and @p last whose subject contains @p needle. The first byte of the
+ * needle is looked up with memchr, which the C library vectorises, so only its occurrences are compared in full.
+ */
+void markSubjects(const QByteArray &subjects, const QVector<qsizetype> &offsets, const QByteArray &needle, int first,
+                  int last, std::vector<char> &marks)
+{
+   const auto data = subjects.constData();
+   const auto end = data + offsets.at(last);
+   const auto needleSize = static_cast<qsizetype>(needle.size());
+   auto position = data + offsets.at(first);
+
+   while (end - position >= needleSize)
+   {
+      const auto found
+          = static_cast<const char *>(std::memchr(position, needle.at(0), static_cast<size_t>(end - position)));
+
+      if (!found || end - found < needleSize)
+         break;
+
+      if (std::memcmp(found, needle.constData(), static_cast<size_t>(needleSize)) != 0)
+      {
+         position = found + 1;
+         continue;
+      }
+
+      // The needle has no line breaks, so the match can't cross the end of the subject.
+      const auto offset = found - data;
+      const auto document = static_cast<int>(
+          std::upper_bound(offsets.cbegin() + first, offsets.cbegin() + last + 1, offset) - offsets.cbegin() - 1);
+
+      marks[static_cast<size_t>(document)] = 1;
+      position = data + offsets.at(document + 1);
+   }
+}
+}
+
+void CommitSearchIndex::Posting::append(int document)
+{
+   auto delta = static_cast<quint32>(document - last);
+
+   while (delta >= 0x80)
+   {
+      deltas.append(static_cast<char>((delta & 0x7f) | 0x80));
+      delta >>= 7;
+   }
+
+   deltas.append(static_cast<char>(delta));
+   last = document;
+   ++count;
+}
+
+QVector<int> CommitSearchIndex::Posting::documents() const
+{
+   QVector<int> documents;
+   documents.reserve(count);
+
+   auto document = -1;
+   quint32 delta = 0;
+   auto shift = 0;
+
+   for (const auto byte : deltas)
+   {
+      const auto value = static_cast<uchar>(byte);
+
+      delta |= static_cast<quint32>(value & 0x7f) << shift;
+
+      if (value & 0x80)
+         shift += 7;
+      else
+      {
+         document += static_cast<int>(delta);
+         documents.append(document);
+         delta = 0;
+         shift = 0;
+      }
+   }
+
+   return documents;
+}
+
+CommitSearchIndex::CommitSearchIndex(QObject *parent)
+   : QThread(parent)
+{
+}
+
+CommitSearchIndex::~CommitSearchIndex()
+{
+   {
+      QMutexLocker lock(&mMutex);
+      mStop = true;
+      mPending.reset();
+      mCondition.wakeAll();
+   }
+
+   wait();
+}
+
+void CommitSearchIndex::update(std::shared_ptr<const CommitTable> commits)
+{
+   {
+      QMutexLocker lock(&mMutex);
+      mPending = std::move(commits);
+      mCondition.wakeAll();
+   }
+
+   if (!isRunning())
+      start(QThread::LowPriority);
+}
+
+void CommitSearchIndex::clear()
+{
+   QMutexLocker lock(&mMutex);
+
+   ++mGeneration;
+   mPending.reset();
+   mIndexed.reset();
+   mDocuments.clear();
+   mDocumentRows.clear();
+   mAuthors.clear();
+   mCommitters.clear();
+   mIdentities.clear();
+   mIdentityIds.clear();
+   mPostings.clear();
+   mSubjects.clear();
+   mSubjectOffsets = { 0 };
+   mShaBuckets.clear();
+   mShaRows.clear();
+   mWipRow = -1;
+}
+
+bool CommitSearchIndex::find(const QString &text, const CommitTable &commits, int startingPoint, bool reverse,
+                             int *row) const
+{
+   if (text.isEmpty())
+      return false;
+
+   QMutexLocker lock(&mMutex);
+
+   if (mIndexed.get() != &commits)
+      return false;
+
+   const auto rows = text.size() < MIN_QUERY_SIZE ? scan(text, commits) : candidates(text);
+
+   lock.unlock();
+
+   // The candidates are sorted, so they are verified in the same order as the scan until one really matches.
+   const auto matches = [&commits, &text](int candidate) { return commits.contains(candidate, text); };
+
+   if (reverse)
+   {
+      const auto lastRow = commits.count() - 1;
+      const auto startingRow = startingPoint > 0 ? std::min(startingPoint - 2, lastRow) : lastRow;
+      const auto start = std::make_reverse_iterator(std::upper_bound(rows.cbegin(), rows.cend(), startingRow));
+      auto match = std::find_if(start, rows.crend(), matches);
+
+      if (match == rows.crend())
+      {
+         match = std::find_if(rows.crbegin(), start, matches);
+         match = match != start ? match : rows.crend();
+      }
+
+      *row = match != rows.crend() ? *match : -1;
+   }
+   else
+   {
+      const auto start = std::lower_bound(rows.cbegin(), rows.cend(), std::max(startingPoint, 0));
+      auto match = std::find_if(start, rows.cend(), matches);
+
+      if (match == rows.cend())
+      {
+         match = std::find_if(rows.cbegin(), start, matches);
+         match = match != start ? match : rows.cend();
+      }
+
+      *row = match != rows.cend() ? *match : -1;
+   }
+
+   return true;
+}
+
+void CommitSearchIndex::run()
+{
+   forever
+   {
+      std::shared_ptr<const CommitTable> commits;
+
+      {
+         QMutexLocker lock(&mMutex);
+
+         while (!mPending && !mStop)
+            mCondition.wait(&mMutex);
+
+         if (mStop)
+            return;
+
+         commits = std::move(mPending);
+         mPending.reset();
+      }
+
+      index(commits);
+   }
+}
+
+void CommitSearchIndex::index(const std::shared_ptr<const CommitTable> &commits)
+{
+   const auto totalRows = commits->count();
+   QVector<int> rowDocuments(totalRows, -1);
+   QVector<int> rowBuckets(totalRows, 0);
+   auto wipRow = -1;
+   auto added = 0;
+   auto generation = 0;
+
+   {
+      QMutexLocker lock(&mMutex);
+      mIndexed.reset();
+      generation = mGeneration;
+   }
+
+   // The lock is released between chunks so the queries don't wait for the whole snapshot.
+   for (auto first = 0; first < totalRows; first += CHUNK_ROWS)
+   {
+      QMutexLocker lock(&mMutex);
+
+      if (mStop || mPending || generation != mGeneration)
+         return;
+
+      for (auto row = first; row < std::min(first + CHUNK_ROWS, totalRows); ++row)
+      {
+         const auto &oid = commits->oid(row);
+
+         // The WIP changes without changing its SHA, so it's always verified instead of indexed.
+         if (oid == Oid())
+         {
+            wipRow = row;
+            continue;
+         }
+
+         auto document = mDocuments.value(oid, -1);
+
+         if (document == -1 && commits->hasMetadata(row))
+         {
+            document = addDocument(*commits, row);
+            ++added;
+         }
+
+         rowDocuments[row] = document;
+         rowBuckets[row] = shaBucket(oid);
+      }
+   }
+
+   qsizetype totalDocuments = 0;
+
+   {
+      QMutexLocker lock(&mMutex);
+
+      if (generation != mGeneration)
+         return;
+
+      totalDocuments = mAuthors.count();
+   }
+
+   QVector<int> documentRows(totalDocuments, -1);
+   QVector<int> shaBuckets(SHA_BUCKETS + 1, 0);
+   QVector<int> shaRows(totalRows);
+
+   for (auto row = 0; row < totalRows; ++row)
+   {
+      if (rowDocuments.at(row) != -1)
+         documentRows[rowDocuments.at(row)] = row;
+
+      ++shaBuckets[rowBuckets.at(row) + 1];
+   }
+
+   for (auto bucket = 0; bucket < SHA_BUCKETS; ++bucket)
+      shaBuckets[bucket + 1] += shaBuckets.at(bucket);
+
+   auto offsets = shaBuckets;
+
+   for (auto row = 0; row < totalRows; ++row)
+      shaRows[offsets[rowBuckets.at(row)]++] = row;
+
+   {
+      QMutexLocker lock(&mMutex);
+
+      if (mStop || mPending || generation != mGeneration)
+         return;
+
+      mDocumentRows = std::move(documentRows);
+      mShaBuckets = std::move(shaBuckets);
+      mShaRows = std::move(shaRows);
+      mWipRow = wipRow;
+      mIndexed = commits;
+
+      if (added > 0)
+      {
+         QLog_Debug("Cache",
+                    QString("Indexed {%1} commits for the search ({%2} in total, {%3} trigrams).")
+                        .arg(added)
+                        .arg(mAuthors.count())
+                        .arg(mPostings.count()));
+      }
+   }
+
+   emit indexed();
+}
+
+int CommitSearchIndex::addDocument(const CommitTable &commits, int row)
+{
+   const auto document = static_cast<int>(mAuthors.count());
+
+   mDocuments.insert(commits.oid(row), document);
+   mAuthors.append(identityId(commits.author(row)));
+   mCommitters.append(identityId(commits.committer(row)));
+
+   const auto subject = commits.shortLog(row).toCaseFolded();
+
+   // The documents are added in increasing order, so the posting lists stay sorted and their deltas positive.
+   for (const auto key : trigrams(subject))
+      mPostings[key].append(document);
+
+   mSubjects.append(subject.toUtf8());
+   mSubjects.append('\n');
+   mSubjectOffsets.append(mSubjects.size());
+
+   return document;
+}
+
+int CommitSearchIndex::identityId(const QString &identity)
+{
+   if (const auto iter = mIdentityIds.constFind(identity); iter != mIdentityIds.cend())
+      return *iter;
+
+   const auto id = static_cast<int>(mIdentities.count());
+
+   mIdentities.append(identity);
+   mIdentityIds.insert(identity, id);
+
+   return id;
+}
+
+QVector<int> CommitSearchIndex::candidates(const QString &text) const
+{
+   QVector<int> rows;
+
+   for (const auto document : subjectDocuments(text.toCaseFolded()))
+   {
+      if (const auto row = mDocumentRows.at(document); row != -1)
+         rows.append(row);
+   }
+
+   if (const auto identities = matchingIdentities(text); identities.contains(true))
+   {
+      for (auto document = 0; document < mAuthors.count(); ++document)
+      {
+         const auto row = mDocumentRows.at(document);
+
+         if (row != -1 && (identities.at(mAuthors.at(document)) || identities.at(mCommitters.at(document))))
+            rows.append(row);
+      }
+   }
+
+   if (const auto bucket = shaBucket(text); bucket != -1)
+   {
+      for (auto i = mShaBuckets.at(bucket); i < mShaBuckets.at(bucket + 1); ++i)
+         rows.append(mShaRows.at(i));
+   }
+
+   if (mWipRow != -1)
+      rows.append(mWipRow);
+
+   std::sort(rows.begin(), rows.end());
+   rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+   return rows;
+}
+
+QVector<int> CommitSearchIndex::subjectDocuments(const QString &text) const
+{
+   QVector<const Posting *> postings;
+
+   for (const auto key : trigrams(text))
+   {
+      const auto iter = mPostings.constFind(key);
+
+      if (iter == mPostings.cend())
+         return {};
+
+      postings.append(&*iter);
+   }
+
+   if (postings.isEmpty())
+      return {};
+
+   // Only the rarest trigrams are intersected: the candidates left are few enough to be verified directly.
+   std::sort(postings.begin(), postings.end(),
+             [](const Posting *first, const Posting *second) { return first->count < second->count; });
+
+   auto documents = postings.constFirst()->documents();
+
+   for (auto i = 1; i < std::min(static_cast<int>(postings.count()), MAX_INTERSECTED) && !documents.isEmpty(); ++i)
+   {
+      const auto others = postings.at(i)->documents();
+      QVector<int> intersection;
+
+      std::set_intersection(documents.cbegin(), documents.cend(), others.cbegin(), others.cend(),
+                            std::back_inserter(intersection));
+
+      documents = std::move(intersection);
+   }
+
+   return documents;
+}
+
+QVector<int> CommitSearchIndex::scan(const QString &text, const CommitTable &commits) const
+{
+   const auto needle = text.toCaseFolded().toUtf8();
+   const auto identities = matchingIdentities(text);
+   const auto anyIdentity = identities.contains(true);
+   auto isSha = false;
+   const auto shaPrefix = OidPrefix::fromString(text, &isSha);
+   const auto totalRows = commits.count();
+   const auto totalDocuments = static_cast<int>(mAuthors.count());
+   std::vector<char> rowMarks(static_cast<size_t>(totalRows), 0);
+   std::vector<char> documentMarks(static_cast<size_t>(totalDocuments), 0);
+
+   // Every part writes its own range of documents and rows, so the marks can be shared without locking.
+   const auto scanPart = [&](int part, int parts) {
+      const auto firstDocument = static_cast<int>(static_cast<qint64>(totalDocuments) * part / parts);
+      const auto lastDocument = static_cast<int>(static_cast<qint64>(totalDocuments) * (part + 1) / parts);
+
+      markSubjects(mSubjects, mSubjectOffsets, needle, firstDocument, lastDocument, documentMarks);
+
+      for (auto document = firstDocument; anyIdentity && document < lastDocument; ++document)
+      {
+         if (identities.at(mAuthors.at(document)) || identities.at(mCommitters.at(document)))
+            documentMarks[static_cast<size_t>(document)] = 1;
+      }
+
+      const auto firstRow = static_cast<int>(static_cast<qint64>(totalRows) * part / parts);
+      const auto lastRow = static_cast<int>(static_cast<qint64>(totalRows) * (part + 1) / parts);
+
+      for (auto row = firstRow; isSha && row < lastRow; ++row)
+      {
+         if (shaPrefix.matches(commits.oid(row)))
+            rowMarks[static_cast<size_t>(row)] = 1;
+      }
+   };
+
+   // The parts run in the global pool, so the queries typed one after the other don't start threads every time.
+   const auto pool = QThreadPool::globalInstance();
+   const auto parts = std::clamp(std::max(totalRows, totalDocuments) / MIN_SCAN_ROWS, 1, pool->maxThreadCount());
+   QSemaphore done;
+
+   for (auto part = 1; part < parts; ++part)
+   {
+      pool->start([&scanPart, &done, part, parts]() {
+         scanPart(part, parts);
+         done.release();
+      });
+   }
+
+   scanPart(0, parts);
+
+   done.acquire(parts - 1);
+
+   for (auto document = 0; document < totalDocuments; ++document)
+   {
+      if (const auto row = mDocumentRows.at(document); documentMarks[static_cast<size_t>(document)] && row != -1)
+         rowMarks[static_cast<size_t>(row)] = 1;
+   }
+
+   if (mWipRow != -1)
+      rowMarks[static_cast<size_t>(mWipRow)] = 1;
+
+   QVector<int> rows;
+   const auto marks = rowMarks.data();
+   const auto end = marks + rowMarks.size();
+
+   for (auto mark = marks; (mark = static_cast<char *>(std::memchr(mark, 1, static_cast<size_t>(end - mark))));
+        ++mark)
+   {
+      rows.append(static_cast<int>(mark - marks));
+   }
+
+   return rows;
+}
+
+QVector<bool> CommitSearchIndex::matchingIdentities(const QString &text) const
+{
+   QVector<bool> identities(mIdentities.count(), false);
+
+   for (auto id = 0; id < mIdentities.count(); ++id)
+      identities[id] = mIdentities.at(id).contains(text, Qt::CaseInsensitive);
+
+   return identities;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <Oid.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <memory>
+
+class CommitTable;
+
+/**
+ * @brief The CommitSearchIndex class indexes the commits of the published snapshots so the history can be searched
+ * without walking the whole table. The subjects are split in case-folded trigrams whose posting lists are stored
+ * delta-encoded, the authors and committers are interned and the rows are bucketed by the first three digits of their
+ * SHA.
+ *
+ * The case-folded subjects are also kept in a single UTF-8 column. The texts too short to have trigrams are searched
+ * by scanning it in parallel, together with the SHAs of the table.
+ *
+ * The index is built in its own thread and follows the snapshots incrementally: only the commits that weren't indexed
+ * yet are read, and a snapshot that is replaced before it's finished is skipped. The queries are only served when the
+ * index is up to date with the snapshot they search, and every candidate is verified against the table.
+ */
+class CommitSearchIndex : public QThread
+{
+   Q_OBJECT
+
+signals:
+   /**
+    * @brief Emitted from the index thread when a snapshot is completely indexed and the queries on it can be served.
+    */
+   void indexed();
+
+public:
+   /**
+    * @brief Shortest text the trigrams can look up. Shorter texts are searched by scanning the subjects column.
+    */
+   static constexpr int MIN_QUERY_SIZE = 3;
+
+   explicit CommitSearchIndex(QObject *parent = nullptr);
+   ~CommitSearchIndex() override;
+
+   /**
+    * @brief Queues a new snapshot to be indexed. The thread is started the first time it's called.
+    */
+   void update(std::shared_ptr<const CommitTable> commits);
+   void clear();
+
+   /**
+    * @brief Searches the first commit that contains @p text with the same rules as a scan of the table: starting at
+    * @p startingPoint (or before it when @p reverse is true) and wrapping around the history.
+    *
+    * @param row The row found, or -1 if no commit matches.
+    * @return True if the index served the query, false if it's not up to date with @p commits.
+    */
+   bool find(const QString &text, const CommitTable &commits, int startingPoint, bool reverse, int *row) const;
+
+protected:
+   void run() override;
+
+private:
+   struct Posting
+   {
+      QByteArray deltas;
+      int last = -1;
+      int count = 0;
+
+      void append(int document);
+      QVector<int> documents() const;
+   };
+
+   mutable QMutex mMutex;
+   QWaitCondition mCondition;
+   std::shared_ptr<const CommitTable> mPending;
+   bool mStop = false;
+   int mGeneration = 0;
+
+   std::shared_ptr<const CommitTable> mIndexed; // The table the rows refer to. Null while a snapshot is indexed.
+   QHash<Oid, int> mDocuments;
+   QVector<int> mDocumentRows;
+   QVector<int> mAuthors;
+   QVector<int> mCommitters;
+   QVector<QString> mIdentities;
+   QHash<QString, int> mIdentityIds;
+   QHash<quint64, Posting> mPostings;
+   QByteArray mSubjects; // Case-folded UTF-8 subjects of the documents, each one ended by a line break.
+   QVector<qsizetype> mSubjectOffsets { 0 };
+   QVector<int> mShaBuckets;
+   QVector<int> mShaRows;
+   int mWipRow = -1;
+
+   void index(const std::shared_ptr<const CommitTable> &commits);
+   int addDocument(const CommitTable &commits, int row);
+   int identityId(const QString &identity);
+   QVector<int> candidates(const QString &text) const;
+   QVector<int> scan(const QString &text, const CommitTable &commits) const;
+   QVector<bool> matchingIdentities(const QString &text) const;
+   QVector<int> subjectDocuments(const QString &text) const;
+};
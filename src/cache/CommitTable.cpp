@@ -0,0 +1,958 @@
+#include "CommitTable.h"
+
+#include <QIODevice>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+
+namespace
+{
+const quint32 CACHE_MAGIC = 0x47514354; // "GQCT"
+const quint32 CACHE_VERSION = 2;
+
+template<typename T>
+bool writeValue(QIODevice &device, T value)
+{
+   static_assert(std::is_trivially_copyable_v<T>);
+
+   return device.write(reinterpret_cast<const char *>(&value), sizeof(T)) == sizeof(T);
+}
+
+template<typename T>
+bool writeArray(QIODevice &device, const QVector<T> &array)
+{
+   static_assert(std::is_trivially_copyable_v<T>);
+
+   const auto bytes = static_cast<qint64>(array.count() * sizeof(T));
+
+   return writeValue<qint64>(device, array.count())
+       && device.write(reinterpret_cast<const char *>(array.constData()), bytes) == bytes;
+}
+
+bool writeBytes(QIODevice &device, const QByteArray &bytes)
+{
+   return writeValue<qint64>(device, bytes.size()) && device.write(bytes) == bytes.size();
+}
+
+/**
+ * @brief Reads the values written by writeValue, writeArray and writeBytes from the mapped file.
+ */
+class CacheReader
+{
+public:
+   CacheReader(const uchar *data, qsizetype size)
+      : mData(data)
+      , mSize(size)
+   {
+   }
+
+   bool isValid() const { return mValid; }
+
+   template<typename T>
+   T value()
+   {
+      T value {};
+
+      if (take(sizeof(T)))
+         std::memcpy(&value, mData + mPos - sizeof(T), sizeof(T));
+
+      return value;
+   }
+
+   template<typename T>
+   QVector<T> array()
+   {
+      QVector<T> array;
+      const auto count = value<qint64>();
+
+      if (count < 0 || count > (mSize - mPos) / static_cast<qint64>(sizeof(T)))
+         mValid = false;
+      else
+      {
+         array.resize(count);
+
+         if (take(count * sizeof(T)))
+            std::memcpy(array.data(), mData + mPos - count * sizeof(T), count * sizeof(T));
+      }
+
+      return array;
+   }
+
+   QByteArray bytes()
+   {
+      const auto count = value<qint64>();
+
+      if (count < 0 || !take(count))
+         return QByteArray();
+
+      return QByteArray(reinterpret_cast<const char *>(mData + mPos - count), count);
+   }
+
+private:
+   const uchar *mData = nullptr;
+   qsizetype mSize = 0;
+   qsizetype mPos = 0;
+   bool mValid = true;
+
+   bool take(qsizetype bytes)
+   {
+      mValid = mValid && bytes <= mSize - mPos;
+
+      if (mValid)
+         mPos += bytes;
+
+      return mValid;
+   }
+};
+}
+
+void CommitTable::clear()
+{
+   mOids.clear();
+   mOids.squeeze();
+   mDates.clear();
+   mDates.squeeze();
+   mCommitters.clear();
+   mCommitters.squeeze();
+   mAuthors.clear();
+   mAuthors.squeeze();
+   mMessageOffsets.clear();
+   mMessageOffsets.squeeze();
+   mShortLogSizes.clear();
+   mShortLogSizes.squeeze();
+   mLongLogSizes.clear();
+   mLongLogSizes.squeeze();
+   mMessages.clear();
+   mMessages.squeeze();
+   mParentOffsets = { 0 };
+   mParents.clear();
+   mParents.squeeze();
+   mExternalOids.clear();
+   mExternalOids.squeeze();
+   mPendingParents.clear();
+   mPendingParents.squeeze();
+   mFirstChilds.clear();
+   mFirstChilds.squeeze();
+   mExtraChilds.clear();
+   mExtraChilds.squeeze();
+   mIdentities.clear();
+   mIdentities.squeeze();
+   mIdentityIds.clear();
+   mIdentityIds.squeeze();
+   mSignatures.clear();
+   mSignatures.squeeze();
+   mRows.clear();
+   mRows.squeeze();
+   mSortedRows.clear();
+   mSortedRows.squeeze();
+
+   resetLanes();
+}
+
+void CommitTable::reserve(int commits)
+{
+   mOids.reserve(commits);
+   mDates.reserve(commits);
+   mCommitters.reserve(commits);
+   mAuthors.reserve(commits);
+   mMessageOffsets.reserve(commits);
+   mShortLogSizes.reserve(commits);
+   mLongLogSizes.reserve(commits);
+   mParentOffsets.reserve(commits + 1);
+   mParents.reserve(commits);
+   mFirstChilds.reserve(commits);
+   mRows.reserve(commits);
+}
+
+void CommitTable::append(const CommitInfo &commit)
+{
+   insert(count(), QVector<CommitInfo> { commit });
+}
+
+void CommitTable::append(const QVector<CommitInfo> &commits)
+{
+   insert(count(), commits);
+}
+
+void CommitTable::insert(int row, const CommitInfo &commit)
+{
+   insert(row, QVector<CommitInfo> { commit });
+}
+
+void CommitTable::insert(int row, const QVector<CommitInfo> &commits)
+{
+   const auto total = static_cast<int>(commits.count());
+
+   if (total == 0)
+      return;
+
+   row = std::clamp(row, 0, count());
+
+   if (row < count())
+   {
+      shiftRows(row, total);
+
+      // Only the lanes from the new rows on change. The copies of the table keep the layout that matches their rows.
+      mLaneLayout = mLaneLayout->invalidated(row, total);
+   }
+
+   mSortedRows.clear();
+
+   // The room for all the new rows is made at once so the columns are moved only once.
+   mOids.insert(row, total, Oid());
+   mDates.insert(row, total, 0);
+   mCommitters.insert(row, total, 0);
+   mAuthors.insert(row, total, 0);
+   mMessageOffsets.insert(row, total, 0);
+   mShortLogSizes.insert(row, total, 0);
+   mLongLogSizes.insert(row, total, 0);
+   mFirstChilds.insert(row, total, -1);
+
+   auto totalParents = 0;
+
+   for (const auto &commit : commits)
+      totalParents += static_cast<int>(commit.mParentsSha.count());
+
+   const auto parentStart = mParentOffsets.at(row);
+
+   if (totalParents > 0)
+   {
+      for (auto &pending : mPendingParents)
+      {
+         for (auto &slot : pending.slots)
+         {
+            if (slot >= parentStart)
+               slot += totalParents;
+         }
+      }
+
+      for (auto i = row + 1; i < mParentOffsets.count(); ++i)
+         mParentOffsets[i] += totalParents;
+
+      mParents.insert(parentStart, totalParents, 0);
+   }
+
+   QVector<int> parentOffsets;
+   parentOffsets.reserve(total);
+
+   auto parentEnd = parentStart;
+
+   for (const auto &commit : commits)
+   {
+      parentEnd += static_cast<int>(commit.mParentsSha.count());
+      parentOffsets.append(parentEnd);
+   }
+
+   mParentOffsets.insert(row + 1, total, 0);
+
+   for (auto i = 0; i < total; ++i)
+      mParentOffsets[row + 1 + i] = parentOffsets.at(i);
+
+   QHash<int, int> resolvedParents;
+
+   for (auto i = 0; i < total; ++i)
+   {
+      if (const auto external = fillRow(row + i, commits.at(i)); external != -1)
+         resolvedParents.insert(LaneLayout::laneId(-(external + 1)), row + i);
+   }
+
+   // The lanes identify the parents that were not in the table by their reference, which is their row now.
+   if (!resolvedParents.isEmpty())
+      mLaneLayout = mLaneLayout->renamed(resolvedParents);
+}
+
+int CommitTable::fillRow(int row, const CommitInfo &commit)
+{
+   auto validOid = false;
+   const auto oid = Oid::fromString(commit.sha, &validOid);
+
+   mOids[row] = oid;
+   mDates[row] = commit.dateSinceEpoch.count();
+   mCommitters[row] = identityId(commit.committer);
+   mAuthors[row] = identityId(commit.author);
+
+   if (!commit.gpgKey.isEmpty())
+      mSignatures.insert(row, { commit.gpgKey, commit.mGoodSignature });
+
+   setMessage(row, commit);
+
+   auto slot = mParentOffsets.at(row);
+
+   for (const auto &parent : commit.mParentsSha)
+   {
+      auto validParent = false;
+      const auto parentOid = Oid::fromString(parent, &validParent);
+      auto reference = 0;
+
+      // An invalid SHA reads as the zero id of the WIP commit: it's kept outside of the table so it's never linked.
+      if (validParent)
+         reference = parentReference(parentOid, slot);
+      else
+      {
+         mExternalOids.append(parentOid);
+         reference = -static_cast<int>(mExternalOids.count());
+      }
+
+      mParents[slot++] = reference;
+
+      if (reference >= 0)
+         linkChild(reference, row);
+   }
+
+   if (!validOid)
+      return -1;
+
+   mRows.insert(oid, row);
+
+   // The children that were added before this commit can be linked now.
+   if (const auto pending = mPendingParents.take(oid); !pending.slots.isEmpty())
+   {
+      for (const auto pendingSlot : pending.slots)
+      {
+         const auto child = std::upper_bound(mParentOffsets.cbegin(), mParentOffsets.cend(), pendingSlot) - 1;
+
+         mParents[pendingSlot] = row;
+         linkChild(row, static_cast<int>(child - mParentOffsets.cbegin()));
+      }
+
+      return pending.external;
+   }
+
+   return -1;
+}
+
+void CommitTable::update(int row, const CommitInfo &commit)
+{
+   if (row < 0 || row >= count())
+      return;
+
+   if (const auto oid = Oid::fromString(commit.sha); oid != mOids.at(row))
+   {
+      mRows.remove(mOids.at(row));
+      mOids[row] = oid;
+      mRows.insert(oid, row);
+      mSortedRows.clear();
+      resetLanes();
+   }
+
+   // Only the columns that change are written: a published snapshot shares them and any write detaches a copy.
+   if (mDates.at(row) != commit.dateSinceEpoch.count())
+      mDates[row] = commit.dateSinceEpoch.count();
+
+   if (const auto committer = identityId(commit.committer); mCommitters.at(row) != committer)
+      mCommitters[row] = committer;
+
+   if (const auto author = identityId(commit.author); mAuthors.at(row) != author)
+      mAuthors[row] = author;
+
+   if (commit.gpgKey.isEmpty())
+   {
+      if (mSignatures.contains(row))
+         mSignatures.remove(row);
+   }
+   else if (gpgKey(row) != commit.gpgKey || verifiedSignature(row) != commit.mGoodSignature)
+      mSignatures.insert(row, { commit.gpgKey, commit.mGoodSignature });
+
+   setMessage(row, commit);
+
+   if (parents(row) != commit.mParentsSha)
+   {
+      setParents(row, commit.mParentsSha);
+      mLaneLayout = mLaneLayout->invalidated(row, 0);
+   }
+}
+
+void CommitTable::finish()
+{
+   // While loading, every parent that comes after its child is kept as external until it arrives. Once the load is
+   // done, only the parents that are really outside of the table are kept.
+   QVector<Oid> externals;
+   QVector<int> remap(mExternalOids.count(), -1);
+   QHash<int, int> renamedParents;
+
+   for (auto &parent : mParents)
+   {
+      if (parent < 0)
+      {
+         auto &external = remap[-parent - 1];
+
+         if (external == -1)
+         {
+            external = externals.count();
+            externals.append(mExternalOids.at(-parent - 1));
+
+            if (const auto reference = -(external + 1); reference != parent)
+               renamedParents.insert(LaneLayout::laneId(parent), LaneLayout::laneId(reference));
+         }
+
+         parent = -(external + 1);
+      }
+   }
+
+   mExternalOids = std::move(externals);
+   mPendingParents.clear();
+   mPendingParents.squeeze();
+
+   if (!renamedParents.isEmpty())
+      mLaneLayout = mLaneLayout->renamed(renamedParents);
+}
+
+void CommitTable::setMetadataPending(int firstRow, int count)
+{
+   const auto end = std::min(firstRow + count, this->count());
+   const auto unknown = identityId(QString());
+
+   for (auto row = std::max(firstRow, 0); row < end; ++row)
+   {
+      mCommitters[row] = unknown;
+      mAuthors[row] = unknown;
+      mMessageOffsets[row] = -1;
+      mShortLogSizes[row] = 0;
+      mLongLogSizes[row] = 0;
+   }
+}
+
+bool CommitTable::save(QIODevice &device, const QByteArray &key) const
+{
+   QVector<qint64> messageOffsets(mMessageOffsets.cbegin(), mMessageOffsets.cend());
+   QVector<int> extraChilds;
+
+   for (auto iter = mExtraChilds.cbegin(); iter != mExtraChilds.cend(); ++iter)
+   {
+      extraChilds.append(iter.key());
+      extraChilds.append(static_cast<int>(iter.value().count()));
+      extraChilds.append(iter.value());
+   }
+
+   auto ok = writeValue(device, CACHE_MAGIC) && writeValue(device, CACHE_VERSION) && writeBytes(device, key)
+       && writeArray(device, mOids) && writeArray(device, mDates) && writeArray(device, mCommitters)
+       && writeArray(device, mAuthors) && writeArray(device, messageOffsets) && writeArray(device, mShortLogSizes)
+       && writeArray(device, mLongLogSizes) && writeBytes(device, mMessages) && writeArray(device, mParentOffsets)
+       && writeArray(device, mParents) && writeArray(device, mExternalOids) && writeArray(device, mFirstChilds)
+       && writeArray(device, extraChilds) && writeValue<qint64>(device, mIdentities.count());
+
+   for (auto i = 0; ok && i < mIdentities.count(); ++i)
+      ok = writeBytes(device, mIdentities.at(i).toUtf8());
+
+   ok = ok && writeValue<qint64>(device, mSignatures.count());
+
+   for (auto iter = mSignatures.cbegin(); ok && iter != mSignatures.cend(); ++iter)
+   {
+      ok = writeValue(device, iter.key()) && writeValue<char>(device, iter->good)
+          && writeBytes(device, iter->gpgKey.toUtf8());
+   }
+
+   return ok;
+}
+
+bool CommitTable::load(const uchar *data, qsizetype size, const QByteArray &key)
+{
+   CacheReader reader(data, size);
+
+   if (reader.value<quint32>() != CACHE_MAGIC || reader.value<quint32>() != CACHE_VERSION || reader.bytes() != key)
+      return false;
+
+   clear();
+
+   mOids = reader.array<Oid>();
+   mDates = reader.array<qint64>();
+   mCommitters = reader.array<int>();
+   mAuthors = reader.array<int>();
+
+   const auto messageOffsets = reader.array<qint64>();
+   mMessageOffsets = QVector<qsizetype>(messageOffsets.cbegin(), messageOffsets.cend());
+   mShortLogSizes = reader.array<int>();
+   mLongLogSizes = reader.array<int>();
+   mMessages = reader.bytes();
+   mParentOffsets = reader.array<int>();
+   mParents = reader.array<int>();
+   mExternalOids = reader.array<Oid>();
+   mFirstChilds = reader.array<int>();
+
+   const auto extraChilds = reader.array<int>();
+   auto validExtraChilds = true;
+
+   for (auto i = 0; i < extraChilds.count();)
+   {
+      const auto childs = i + 1 < extraChilds.count() ? extraChilds.at(i + 1) : -1;
+
+      if (childs < 0 || childs > extraChilds.count() - i - 2)
+      {
+         validExtraChilds = false;
+         break;
+      }
+
+      mExtraChilds.insert(extraChilds.at(i), extraChilds.mid(i + 2, childs));
+      i += 2 + childs;
+   }
+
+   const auto identities = reader.value<qint64>();
+
+   for (auto i = 0; reader.isValid() && i < identities; ++i)
+   {
+      mIdentities.append(QString::fromUtf8(reader.bytes()));
+      mIdentityIds.insert(mIdentities.constLast(), i);
+   }
+
+   const auto signatures = reader.value<qint64>();
+
+   for (auto i = 0; reader.isValid() && i < signatures; ++i)
+   {
+      const auto row = reader.value<int>();
+      const auto good = reader.value<char>() != 0;
+
+      mSignatures.insert(row, { QString::fromUtf8(reader.bytes()), good });
+   }
+
+   const auto rows = mOids.count();
+   const auto consistent = reader.isValid() && validExtraChilds && mDates.count() == rows
+       && mCommitters.count() == rows && mAuthors.count() == rows && mMessageOffsets.count() == rows
+       && mShortLogSizes.count() == rows && mLongLogSizes.count() == rows && mFirstChilds.count() == rows
+       && mParentOffsets.count() == rows + 1 && mParentOffsets.constLast() == mParents.count() && hasValidIndexes();
+
+   if (!consistent)
+   {
+      clear();
+      return false;
+   }
+
+   mRows.reserve(rows);
+
+   for (auto row = 0; row < rows; ++row)
+      mRows.insert(mOids.at(row), row);
+
+   return true;
+}
+
+bool CommitTable::hasValidIndexes() const
+{
+   // The file may be corrupted or written by another build: every index is checked before it's used to read a column.
+   const auto rows = mOids.count();
+   const auto isRow = [rows](int row) { return row >= 0 && row < rows; };
+   const auto isIdentity = [this](int identity) { return identity >= 0 && identity < mIdentities.count(); };
+
+   if (mParentOffsets.constFirst() != 0)
+      return false;
+
+   for (auto row = 0; row < rows; ++row)
+   {
+      if (mParentOffsets.at(row) > mParentOffsets.at(row + 1) || !isIdentity(mCommitters.at(row))
+          || !isIdentity(mAuthors.at(row)) || (mFirstChilds.at(row) != -1 && !isRow(mFirstChilds.at(row))))
+      {
+         return false;
+      }
+
+      const auto offset = mMessageOffsets.at(row);
+      const auto shortLogSize = mShortLogSizes.at(row);
+      const auto longLogSize = mLongLogSizes.at(row);
+
+      // The rows whose metadata is pending have no message.
+      if (shortLogSize < 0 || longLogSize < 0 || offset < -1 || (offset == -1 && shortLogSize + longLogSize != 0)
+          || offset + shortLogSize + longLogSize > mMessages.size())
+      {
+         return false;
+      }
+   }
+
+   for (const auto parent : mParents)
+   {
+      if (parent >= rows || (parent < 0 && -parent - 1 >= mExternalOids.count()))
+         return false;
+   }
+
+   for (auto iter = mExtraChilds.cbegin(); iter != mExtraChilds.cend(); ++iter)
+   {
+      if (!isRow(iter.key()) || !std::all_of(iter->cbegin(), iter->cend(), isRow))
+         return false;
+   }
+
+   for (auto iter = mSignatures.cbegin(); iter != mSignatures.cend(); ++iter)
+   {
+      if (!isRow(iter.key()))
+         return false;
+   }
+
+   return true;
+}
+
+int CommitTable::row(const QString &sha) const
+{
+   auto ok = false;
+   const auto oid = Oid::fromString(sha, &ok);
+
+   return ok ? mRows.value(oid, -1) : -1;
+}
+
+int CommitTable::rowByPrefix(const QString &shaPrefix, bool *ambiguous) const
+{
+   if (ambiguous)
+      *ambiguous = false;
+
+   auto ok = false;
+   const auto prefix = OidPrefix::fromString(shaPrefix, &ok);
+
+   if (!ok)
+      return -1;
+
+   if (mSortedRows.count() != count())
+   {
+      mSortedRows.resize(count());
+      std::iota(mSortedRows.begin(), mSortedRows.end(), 0);
+      std::sort(mSortedRows.begin(), mSortedRows.end(),
+                [this](int row, int other) { return mOids.at(row) < mOids.at(other); });
+   }
+
+   const auto end = mSortedRows.cend();
+   const auto first = std::lower_bound(mSortedRows.cbegin(), end, prefix.lowerBound,
+                                       [this](int row, const Oid &oid) { return mOids.at(row) < oid; });
+
+   if (first == end || !prefix.matches(mOids.at(*first)))
+      return -1;
+
+   if (const auto next = first + 1; next != end && prefix.matches(mOids.at(*next)))
+   {
+      if (ambiguous)
+         *ambiguous = true;
+
+      return -1;
+   }
+
+   return *first;
+}
+
+CommitInfo CommitTable::commit(int row) const
+{
+   CommitInfo commit;
+
+   if (row < 0 || row >= count())
+      return commit;
+
+   const auto message = this->message(row);
+   const auto shortLogSize = mShortLogSizes.at(row);
+
+   commit.pos = static_cast<uint>(row);
+   commit.sha = mOids.at(row).toString();
+   commit.committer = mIdentities.at(mCommitters.at(row));
+   commit.author = mIdentities.at(mAuthors.at(row));
+   commit.dateSinceEpoch = std::chrono::seconds(mDates.at(row));
+   commit.shortLog = QString::fromUtf8(message, shortLogSize);
+   commit.longLog = QString::fromUtf8(message + shortLogSize, mLongLogSizes.at(row));
+
+   if (const auto signature = mSignatures.constFind(row); signature != mSignatures.cend())
+   {
+      commit.gpgKey = signature->gpgKey;
+      commit.mGoodSignature = signature->good;
+   }
+
+   commit.mParentsSha = parents(row);
+   commit.mChilds = childs(row);
+
+   return commit;
+}
+
+QString CommitTable::sha(int row) const
+{
+   return row >= 0 && row < count() ? mOids.at(row).toString() : QString();
+}
+
+QString CommitTable::firstParent(int row) const
+{
+   if (row < 0 || row >= count() || mParentOffsets.at(row) == mParentOffsets.at(row + 1))
+      return QString();
+
+   return referenceSha(mParents.at(mParentOffsets.at(row)));
+}
+
+LaneRow CommitTable::laneRow(int row) const
+{
+   return mLaneLayout->row(*this, row);
+}
+
+bool CommitTable::contains(int row, const QString &text) const
+{
+   const auto message = this->message(row);
+
+   return sha(row).startsWith(text, Qt::CaseInsensitive)
+       || QString::fromUtf8(message, mShortLogSizes.at(row)).contains(text, Qt::CaseInsensitive)
+       || mIdentities.at(mCommitters.at(row)).contains(text, Qt::CaseInsensitive)
+       || mIdentities.at(mAuthors.at(row)).contains(text, Qt::CaseInsensitive);
+}
+
+QString CommitTable::shortLog(int row) const
+{
+   return QString::fromUtf8(message(row), mShortLogSizes.at(row));
+}
+
+QString CommitTable::author(int row) const
+{
+   return mIdentities.at(mAuthors.at(row));
+}
+
+QString CommitTable::committer(int row) const
+{
+   return mIdentities.at(mCommitters.at(row));
+}
+
+qint64 CommitTable::date(int row) const
+{
+   return mDates.at(row);
+}
+
+QString CommitTable::gpgKey(int row) const
+{
+   const auto signature = mSignatures.constFind(row);
+
+   return signature != mSignatures.cend() ? signature->gpgKey : QString();
+}
+
+bool CommitTable::verifiedSignature(int row) const
+{
+   const auto signature = mSignatures.constFind(row);
+
+   return signature != mSignatures.cend() && signature->good && !signature->gpgKey.isEmpty();
+}
+
+int CommitTable::parentsCount(int row) const
+{
+   return mParentOffsets.at(row + 1) - mParentOffsets.at(row);
+}
+
+int CommitTable::parentId(int row, int index) const
+{
+   // The parents outside of the table are identified by their negative reference, unique for each SHA.
+   return mParents.at(mParentOffsets.at(row) + index);
+}
+
+int CommitTable::identityId(const QString &identity)
+{
+   auto id = mIdentityIds.value(identity, -1);
+
+   if (id == -1)
+   {
+      id = mIdentities.count();
+      mIdentities.append(identity);
+      mIdentityIds.insert(identity, id);
+   }
+
+   return id;
+}
+
+void CommitTable::shiftRows(int row, int amount)
+{
+   const auto shift = [row, amount](int &reference) {
+      if (reference >= row)
+         reference += amount;
+   };
+
+   for (auto &parent : mParents)
+      shift(parent);
+
+   for (auto &child : mFirstChilds)
+      shift(child);
+
+   for (auto iter = mRows.begin(); iter != mRows.end(); ++iter)
+      shift(iter.value());
+
+   QHash<int, QVector<int>> extraChilds;
+
+   for (auto iter = mExtraChilds.cbegin(); iter != mExtraChilds.cend(); ++iter)
+   {
+      auto parent = iter.key();
+      auto childs = iter.value();
+
+      shift(parent);
+
+      for (auto &child : childs)
+         shift(child);
+
+      extraChilds.insert(parent, childs);
+   }
+
+   mExtraChilds = std::move(extraChilds);
+
+   QHash<int, Signature> signatures;
+
+   for (auto iter = mSignatures.cbegin(); iter != mSignatures.cend(); ++iter)
+   {
+      auto signatureRow = iter.key();
+      shift(signatureRow);
+      signatures.insert(signatureRow, iter.value());
+   }
+
+   mSignatures = std::move(signatures);
+}
+
+void CommitTable::setMessage(int row, const CommitInfo &commit)
+{
+   const auto shortLog = commit.shortLog.toUtf8();
+   const QByteArray message = shortLog + commit.longLog.toUtf8();
+   const auto offset = mMessageOffsets.at(row);
+
+   // The WIP commit is refreshed often with the same text, so the buffer only grows when the message changes.
+   if (offset >= 0 && shortLog.size() == mShortLogSizes.at(row)
+       && message.size() == mShortLogSizes.at(row) + mLongLogSizes.at(row)
+       && std::equal(message.cbegin(), message.cend(), mMessages.cbegin() + offset))
+   {
+      return;
+   }
+
+   mMessageOffsets[row] = mMessages.size();
+   mShortLogSizes[row] = static_cast<int>(shortLog.size());
+   mLongLogSizes[row] = static_cast<int>(message.size() - shortLog.size());
+   mMessages.append(message);
+}
+
+const char *CommitTable::message(int row) const
+{
+   // The pending rows have empty sizes, so any valid position can be used for them.
+   return mMessages.constData() + std::max<qsizetype>(mMessageOffsets.at(row), 0);
+}
+
+void CommitTable::setParents(int row, const QStringList &parents)
+{
+   const auto start = mParentOffsets.at(row);
+   const auto end = mParentOffsets.at(row + 1);
+   const auto delta = static_cast<int>(parents.count()) - (end - start);
+
+   for (auto slot = start; slot < end; ++slot)
+   {
+      if (const auto reference = mParents.at(slot); reference >= 0)
+         unlinkChild(reference, row);
+      else if (auto pending = mPendingParents.find(mExternalOids.at(-reference - 1)); pending != mPendingParents.end())
+         pending->slots.removeAll(slot);
+   }
+
+   mParents.remove(start, end - start);
+
+   if (delta != 0)
+   {
+      for (auto i = row + 1; i < mParentOffsets.count(); ++i)
+         mParentOffsets[i] += delta;
+
+      for (auto &pending : mPendingParents)
+      {
+         for (auto &slot : pending.slots)
+         {
+            if (slot >= end)
+               slot += delta;
+         }
+      }
+   }
+
+   mParents.insert(start, parents.count(), 0);
+
+   for (auto i = 0; i < parents.count(); ++i)
+   {
+      const auto slot = start + i;
+      const auto reference = parentReference(Oid::fromString(parents.at(i)), slot);
+
+      mParents[slot] = reference;
+
+      if (reference >= 0)
+         linkChild(reference, row);
+   }
+}
+
+int CommitTable::parentReference(const Oid &oid, int slot)
+{
+   if (const auto parentRow = mRows.value(oid, -1); parentRow != -1)
+      return parentRow;
+
+   auto &pending = mPendingParents[oid];
+
+   if (pending.external == -1)
+   {
+      pending.external = mExternalOids.count();
+      mExternalOids.append(oid);
+   }
+
+   pending.slots.append(slot);
+
+   return -(pending.external + 1);
+}
+
+QString CommitTable::referenceSha(int reference) const
+{
+   return reference >= 0 ? mOids.at(reference).toString() : mExternalOids.at(-reference - 1).toString();
+}
+
+void CommitTable::linkChild(int parent, int child)
+{
+   if (mFirstChilds.at(parent) == -1)
+      mFirstChilds[parent] = child;
+   else
+      mExtraChilds[parent].append(child);
+}
+
+void CommitTable::unlinkChild(int parent, int child)
+{
+   auto extra = mExtraChilds.find(parent);
+
+   if (mFirstChilds.at(parent) == child)
+      mFirstChilds[parent] = extra != mExtraChilds.end() ? extra->takeFirst() : -1;
+   else if (extra != mExtraChilds.end())
+      extra->removeAll(child);
+
+   if (extra != mExtraChilds.end() && extra->isEmpty())
+      mExtraChilds.erase(extra);
+}
+
+QStringList CommitTable::parents(int row) const
+{
+   QStringList parents;
+   const auto end = mParentOffsets.at(row + 1);
+
+   for (auto slot = mParentOffsets.at(row); slot < end; ++slot)
+      parents.append(referenceSha(mParents.at(slot)));
+
+   return parents;
+}
+
+QStringList CommitTable::externalParents() const
+{
+   QStringList parents;
+
+   // The invalid SHAs read as the zero id and are not commits git can start from.
+   for (const auto &oid : mExternalOids)
+   {
+      if (oid != Oid() && !mRows.contains(oid))
+         parents.append(oid.toString());
+   }
+
+   return parents;
+}
+
+int CommitTable::childsCount(int row) const
+{
+   const auto first = mFirstChilds.at(row);
+
+   return first == -1 ? 0 : 1 + static_cast<int>(mExtraChilds.value(row).count());
+}
+
+int CommitTable::firstChild(int row) const
+{
+   return mFirstChilds.at(row);
+}
+
+QStringList CommitTable::childs(int row) const
+{
+   QStringList childs;
+
+   if (const auto first = mFirstChilds.at(row); first != -1)
+   {
+      childs.append(mOids.at(first).toString());
+
+      for (const auto child : mExtraChilds.value(row))
+         childs.append(mOids.at(child).toString());
+   }
+
+   return childs;
+}
+
+void CommitTable::resetLanes()
+{
+   // The copies of the table keep the layout that matches their rows.
+   mLaneLayout = std::make_shared<LaneLayout>();
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2022  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+#include <CommitInfo.h>
+#include <LaneLayout.h>
+#include <Oid.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <memory>
+
+class QIODevice;
+
+/**
+ * @brief The CommitTable class stores the commits of the repository column by column. Every field lives in its own
+ * contiguous array indexed by the row of the commit: SHAs are stored in binary, committers and authors are interned,
+ * the messages share a single UTF-8 buffer and the parents and children refer to other rows by index instead of by
+ * SHA or pointer. A CommitInfo is only built when a row is read. The lanes of the graph are not stored: the LaneLayout
+ * of the table calculates them when they are read.
+ *
+ * Rows whose parents have not been added yet (or that are outside of the loaded range) keep the parent SHA aside and
+ * get linked as soon as the parent row is appended.
+ *
+ * The table can be saved to and loaded from a binary file. The file starts with a version and a key that identifies
+ * the order and the references the history was loaded from, so a table is never loaded with a different layout or
+ * for references that have moved since.
+ */
+class CommitTable
+{
+public:
+   int count() const { return mOids.count(); }
+   bool isEmpty() const { return mOids.isEmpty(); }
+
+   void clear();
+   void reserve(int commits);
+
+   void append(const CommitInfo &commit);
+   void append(const QVector<CommitInfo> &commits);
+   void insert(int row, const CommitInfo &commit);
+   void insert(int row, const QVector<CommitInfo> &commits);
+   void update(int row, const CommitInfo &commit);
+   void finish();
+
+   /**
+    * @brief Marks the rows whose author, committer and message are not known yet. They read as empty until update()
+    * is called for them.
+    */
+   void setMetadataPending(int firstRow, int count);
+   bool hasMetadata(int row) const { return mMessageOffsets.at(row) >= 0; }
+
+   bool save(QIODevice &device, const QByteArray &key) const;
+   bool load(const uchar *data, qsizetype size, const QByteArray &key);
+
+   int row(const QString &sha) const;
+   int row(const Oid &oid) const { return mRows.value(oid, -1); }
+   const Oid &oid(int row) const { return mOids.at(row); }
+   int rowByPrefix(const QString &shaPrefix, bool *ambiguous = nullptr) const;
+
+   CommitInfo commit(int row) const;
+   QString sha(int row) const;
+   QString firstParent(int row) const;
+   QStringList parents(int row) const;
+   /**
+    * @brief Returns the parents of the commits of the table that are not in the table: where the history loaded ends.
+    */
+   QStringList externalParents() const;
+   LaneRow laneRow(int row) const;
+   int childsCount(int row) const;
+   int firstChild(int row) const;
+   bool contains(int row, const QString &text) const;
+
+   QString shortLog(int row) const;
+   QString author(int row) const;
+   QString committer(int row) const;
+   qint64 date(int row) const;
+   QString gpgKey(int row) const;
+   bool verifiedSignature(int row) const;
+   int parentsCount(int row) const;
+   bool hasChilds(int row) const { return mFirstChilds.at(row) != -1; }
+   int parentId(int row, int index) const;
+
+private:
+   struct Signature
+   {
+      QString gpgKey;
+      bool good = false;
+   };
+
+   struct PendingParent
+   {
+      int external = -1;
+      QVector<int> slots;
+   };
+
+   QVector<Oid> mOids;
+   QVector<qint64> mDates;
+   QVector<int> mCommitters;
+   QVector<int> mAuthors;
+   QVector<qsizetype> mMessageOffsets; // -1 while the metadata of the row is pending.
+   QVector<int> mShortLogSizes;
+   QVector<int> mLongLogSizes;
+   QByteArray mMessages;
+   QVector<int> mParentOffsets { 0 };
+   QVector<int> mParents; // Row of the parent, or -(index + 1) in mExternalOids when it's not in the table.
+   QVector<Oid> mExternalOids;
+   QHash<Oid, PendingParent> mPendingParents;
+   QVector<int> mFirstChilds;
+   QHash<int, QVector<int>> mExtraChilds;
+   QVector<QString> mIdentities;
+   QHash<QString, int> mIdentityIds;
+   QHash<int, Signature> mSignatures;
+   QHash<Oid, int> mRows;
+   mutable QVector<int> mSortedRows; // Rows sorted by SHA for the prefix lookups. Built on demand.
+   std::shared_ptr<LaneLayout> mLaneLayout = std::make_shared<LaneLayout>(); // Shared with the copies of the table.
+
+   int identityId(const QString &identity);
+   void shiftRows(int row, int amount);
+   int fillRow(int row, const CommitInfo &commit);
+   void setMessage(int row, const CommitInfo &commit);
+   const char *message(int row) const;
+   void setParents(int row, const QStringList &parents);
+   int parentReference(const Oid &oid, int slot);
+   QString referenceSha(int reference) const;
+   void linkChild(int parent, int child);
+   void unlinkChild(int parent, int child);
+   QStringList childs(int row) const;
+   void resetLanes();
+   bool hasValidIndexes() const;
+};
+
+/**
+ * @brief The CommitRow class is a read-only view of one row of a CommitTable. It doesn't copy the commit: every field
+ * is read from the table when it's requested, so the table must outlive the view. Building it doesn't allocate, so it
+ * can be created for every cell painted. It exposes the same accessors as CommitInfo so the painting code can use
+ * either of them.
+ */
+class CommitRow
+{
+public:
+   CommitRow(const CommitTable &table, int row)
+      : mTable(table)
+      , mRow(row)
+   {
+   }
+
+   bool isValid() const { return mRow >= 0 && mRow < mTable.count(); }
+   int row() const { return mRow; }
+   const Oid &oid() const { return mTable.oid(mRow); }
+   QString sha() const { return mTable.sha(mRow); }
+   /**
+    * @brief Tells if the row is the WIP, whose SHA is ZERO_SHA, without converting the id to text.
+    */
+   bool isWip() const { return oid() == Oid(); }
+
+   QString shortLog() const { return mTable.shortLog(mRow); }
+   QString author() const { return mTable.author(mRow); }
+   std::chrono::seconds dateSinceEpoch() const { return std::chrono::seconds(mTable.date(mRow)); }
+   QString gpgKey() const { return mTable.gpgKey(mRow); }
+   bool isSigned() const { return !gpgKey().isEmpty(); }
+   bool verifiedSignature() const { return mTable.verifiedSignature(mRow); }
+   bool hasMetadata() const { return mTable.hasMetadata(mRow); }
+
+   int parentsCount() const { return mTable.parentsCount(mRow); }
+   QStringList parents() const { return mTable.parents(mRow); }
+   bool hasChilds() const { return mTable.hasChilds(mRow); }
+
+   const LaneRow &lanes() const
+   {
+      if (!mLanesRead)
+      {
+         mLanes = mTable.laneRow(mRow);
+         mLanesRead = true;
+      }
+
+      return mLanes;
+   }
+   int getActiveLane() const { return lanes().activeLane(); }
+
+private:
+   const CommitTable &mTable;
+   int mRow = -1;
+   mutable LaneRow mLanes;
+   mutable bool mLanesRead = false;
+};
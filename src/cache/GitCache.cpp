@@ -1,8 +1,16 @@
 #include "GitCache.h"
 
+#include <CommitSearchIndex.h>
 #include <QLogger.h>
 #include <WipRevisionInfo.h>
 
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
 using namespace QLogger;
 
 GitCache::GitCache(QObject *parent)
@@ -12,7 +20,12 @@ GitCache::GitCache(QObject *parent)
    , mRevisionsMutex(QMutex::Recursive)
    , mReferencesMutex(QMutex::Recursive)
 #endif
+   , mSnapshot(std::make_shared<const CommitTable>())
+   , mSearchIndex(std::make_unique<CommitSearchIndex>())
+   , mReferencedRows(std::make_shared<const QBitArray>())
 {
+   connect(mSearchIndex.get(), &CommitSearchIndex::indexed, this, &GitCache::signalSearchIndexUpdated,
+           Qt::DirectConnection);
 }
 
 GitCache::~GitCache()
@@ -24,153 +37,465 @@ void GitCache::setup(const QString &parentSha, const RevisionFiles &files, QVect
 {
    QMutexLocker lock(&mCommitsMutex);
 
-   mCommitsCache = std::move(commits);
+   resetCommits(parentSha, files, commits.count());
+   addCommits(std::move(commits));
+
+   mCommits.finish();
+
+   publishSnapshot(0);
+}
+
+void GitCache::beginSetup(const QString &parentSha, const RevisionFiles &files)
+{
+   QMutexLocker lock(&mCommitsMutex);
+
+   resetCommits(parentSha, files, 0);
+
+   publishSnapshot(0);
+}
+
+void GitCache::appendCommits(QVector<CommitInfo> commits, bool metadataPending)
+{
+   QMutexLocker lock(&mCommitsMutex);
+
+   QLog_Debug("Cache", QString("Appending {%1} revisions to the cache.").arg(commits.count()));
+
+   const auto firstRow = mCommits.count();
+   const auto totalCommits = static_cast<int>(commits.count());
+
+   addCommits(std::move(commits));
+
+   if (metadataPending)
+      mCommits.setMetadataPending(firstRow, totalCommits);
+
+   publishSnapshot(firstRow);
+}
+
+void GitCache::endSetup()
+{
+   QMutexLocker lock(&mCommitsMutex);
+
+   mCommits.finish();
+
+   publishSnapshot(mCommits.count());
+}
+
+void GitCache::setupTopology(const QString &parentSha, const RevisionFiles &files, QVector<CommitInfo> commits)
+{
+   QMutexLocker lock(&mCommitsMutex);
+
+   const auto totalCommits = static_cast<int>(commits.count());
+
+   resetCommits(parentSha, files, totalCommits);
+   addCommits(std::move(commits));
 
+   // The first row is the WIP, which is complete.
+   mCommits.setMetadataPending(1, totalCommits);
+   mCommits.finish();
+
+   publishSnapshot(0);
+}
+
+void GitCache::requestMetadata(int row)
+{
+   static constexpr auto METADATA_BATCH = 100;
+   static constexpr auto METADATA_PREFETCH_ROWS = 1000;
+
+   const auto commits = snapshot();
+   const auto end = std::min(row + METADATA_BATCH, commits->count());
+
+   QMutexLocker lock(&mMetadataMutex);
+
+   const auto wasIdle = mPendingMetadata.isEmpty();
+
+   // The rows after the batch are read in the background, in case the view keeps scrolling. Only a window of them: the
+   // rest of the history is only read for the search.
+   mPrefetchRow = end;
+   mPrefetchEnd = end + METADATA_PREFETCH_ROWS;
+
+   // The rows that follow are very likely to be shown next, so they are read in the same batch.
+   for (auto i = std::max(row, 0); i < end; ++i)
+   {
+      if (!commits->hasMetadata(i))
+      {
+         if (const auto sha = commits->sha(i); !mRequestedMetadata.contains(sha))
+         {
+            mRequestedMetadata.insert(sha);
+            mPendingMetadata.append(sha);
+         }
+      }
+   }
+
+   if (wasIdle && !mPendingMetadata.isEmpty())
+      emit signalMetadataRequested();
+}
+
+QStringList GitCache::takeMetadataRequests()
+{
+   QMutexLocker lock(&mMetadataMutex);
+
+   return std::exchange(mPendingMetadata, QStringList());
+}
+
+void GitCache::requestSearchMetadata()
+{
+   QMutexLocker lock(&mMetadataMutex);
+
+   if (mSearchMetadataRow != -1)
+      return;
+
+   QLog_Debug("Cache", "Reading the metadata of the whole history for the search.");
+
+   mSearchMetadataRow = 0;
+
+   emit signalMetadataRequested();
+}
+
+QStringList GitCache::takeBackgroundMetadataRequests(int count)
+{
+   const auto commits = snapshot();
+   QStringList shas;
+
+   const auto take = [this, &commits, &shas, count](int &row, int end) {
+      for (; row < std::min(end, commits->count()) && shas.count() < count; ++row)
+      {
+         if (!commits->hasMetadata(row))
+         {
+            if (const auto sha = commits->sha(row); !mRequestedMetadata.contains(sha))
+            {
+               mRequestedMetadata.insert(sha);
+               shas.append(sha);
+            }
+         }
+      }
+   };
+
+   QMutexLocker lock(&mMetadataMutex);
+
+   // The window after the rows shown goes first. The walk of the whole history, once the search asked for it, stays at
+   // the end so it also reads the pages loaded later.
+   take(mPrefetchRow, mPrefetchEnd);
+
+   if (mSearchMetadataRow != -1)
+      take(mSearchMetadataRow, std::numeric_limits<int>::max());
+
+   return shas;
+}
+
+void GitCache::updateMetadata(const QVector<CommitInfo> &commits)
+{
+   QMutexLocker lock(&mCommitsMutex);
+
+   // The requested SHAs are kept until the next load, so the commits that git couldn't read are not requested again.
+   for (const auto &commit : commits)
+   {
+      if (const auto row = mCommits.row(commit.sha); row != -1 && !mCommits.hasMetadata(row))
+      {
+         mCommits.update(row, commit);
+
+         mMetadataFirstRow = mMetadataFirstRow == -1 ? row : std::min(mMetadataFirstRow, row);
+         mMetadataLastRow = std::max(mMetadataLastRow, row);
+         mSnapshotOutdated = true;
+      }
+   }
+}
+
+bool GitCache::publishMetadata(int *firstRow, int *lastRow)
+{
+   QMutexLocker lock(&mCommitsMutex);
+
+   if (mMetadataFirstRow == -1)
+      return false;
+
+   // Every snapshot copies the columns written after it and makes the search index walk the table, so the batches of
+   // metadata are published together. Another change might have published them already.
+   if (mSnapshotOutdated)
+      publishSnapshot(mCommits.count());
+
+   *firstRow = std::min(std::exchange(mMetadataFirstRow, -1), mCommits.count() - 1);
+   *lastRow = std::min(std::exchange(mMetadataLastRow, -1), mCommits.count() - 1);
+
+   return true;
+}
+
+void GitCache::resetCommits(const QString &parentSha, const RevisionFiles &files, int totalCommits)
+{
    mInitialized = true;
    mConfigured = false;
 
-   mCommitsMap.clear();
-   mCommitsMap.squeeze();
+   mCommits.clear();
    mUntrackedFiles.clear();
    mUntrackedFiles.squeeze();
-   mLanes.clear();
+   mMetadataFirstRow = -1;
+   mMetadataLastRow = -1;
+
+   {
+      QMutexLocker lock(&mMetadataMutex);
+      mRequestedMetadata.clear();
+      mPendingMetadata.clear();
+      mPrefetchRow = 0;
+      mPrefetchEnd = 0;
+      mSearchMetadataRow = -1;
+   }
 
    QLog_Debug("Cache", QString("Adding WIP revision."));
 
    insertWipRevision(parentSha, files);
 
-   const auto totalCommits = mCommitsCache.count();
-
    QLog_Debug("Cache", QString("Configuring the cache for {%1} elements.").arg(totalCommits));
 
-   mCommitsMap.reserve(totalCommits);
+   mCommits.reserve(totalCommits + 1);
+}
 
-   QLog_Debug("Cache", QString("Adding committed revisions."));
+void GitCache::addCommits(QVector<CommitInfo> commits)
+{
+   mCommits.append(commits);
+}
 
-   QHash<QString, QVector<CommitInfo *>> tmpChildsStorage;
+void GitCache::prependCommits(const QString &parentSha, const RevisionFiles &files, QVector<CommitInfo> commits)
+{
+   QMutexLocker lock(&mRevisionsMutex);
+   QMutexLocker lock2(&mCommitsMutex);
 
-   for (auto iter = mCommitsCache.begin() + 1; iter != mCommitsCache.end(); ++iter)
-   {
-      auto &commit = *iter;
-      calculateLanes(commit);
+   QLog_Debug("Cache", QString("Inserting {%1} new revisions at the top of the cache.").arg(commits.count()));
 
-      if (commit.sha == mCommitsCache[0].firstParent())
-         commit.appendChild(&mCommitsCache[0]);
+   insertRevisionFile(ZERO_SHA, parentSha, files);
 
-      mCommitsMap[commit.sha] = &commit;
+   // The lanes of the rows below the new commits change: the table calculates them again when they are read.
+   auto wip = mCommits.commit(0);
+   wip.setParents(parentSha.isEmpty() ? QStringList() : QStringList { parentSha });
+   wip.shortLog = files.count() == mUntrackedFiles.count() ? tr("No local changes") : tr("Local changes");
+   wip.dateSinceEpoch = std::chrono::seconds(QDateTime::currentSecsSinceEpoch());
 
-      if (tmpChildsStorage.contains(commit.sha))
-      {
-         for (const auto &child : std::as_const(tmpChildsStorage[commit.sha]))
-            commit.appendChild(child);
+   mCommits.insert(1, commits);
+   mCommits.update(0, wip);
 
-         tmpChildsStorage.remove(commit.sha);
-      }
+   publishSnapshot(0);
+}
 
-      for (const auto &parent : std::as_const(commit.mParentsSha))
-         tmpChildsStorage[parent].append(&commit);
+QStringList GitCache::tips() const
+{
+   QMutexLocker lock(&mCommitsMutex);
+
+   QStringList tips;
+   const auto totalCommits = mCommits.count();
+
+   // The WIP is not a real child, so its parent is a tip as well.
+   for (auto row = 1; row < totalCommits; ++row)
+   {
+      if (const auto childs = mCommits.childsCount(row); childs == 0 || (childs == 1 && mCommits.firstChild(row) == 0))
+         tips.append(mCommits.sha(row));
    }
 
-   tmpChildsStorage.clear();
-   tmpChildsStorage.squeeze();
+   return tips;
 }
 
-CommitInfo GitCache::commitInfo(int row)
+QStringList GitCache::boundaryParents() const
 {
    QMutexLocker lock(&mCommitsMutex);
 
-   return row >= 0 && row < mCommitsCache.count() ? mCommitsCache.at(row) : CommitInfo();
+   return mCommits.externalParents();
 }
 
-auto GitCache::searchCommit(const QString &text, const int startingPoint) const
+bool GitCache::saveCommits(const QString &fileName, const QByteArray &key) const
 {
-   return std::find_if(mCommitsCache.constBegin() + startingPoint, mCommitsCache.constEnd(),
-                       [text](const CommitInfo &info) { return info.contains(text); });
+   QMutexLocker lock(&mCommitsMutex);
+
+   QSaveFile file(fileName);
+
+   if (!file.open(QIODevice::WriteOnly))
+      return false;
+
+   if (!mCommits.save(file, key))
+   {
+      file.cancelWriting();
+      return false;
+   }
+
+   return file.commit();
 }
 
-auto GitCache::reverseSearchCommit(const QString &text, int startingPoint) const
+bool GitCache::restoreCommits(const QString &fileName, const QByteArray &key)
 {
-   const auto startEndPos = startingPoint > 0 ? mCommitsCache.count() - startingPoint + 1 : 0;
+   QFile file(fileName);
+
+   if (!file.open(QIODevice::ReadOnly))
+      return false;
+
+   const auto size = file.size();
+   const auto data = file.map(0, size);
+
+   if (!data)
+      return false;
+
+   QMutexLocker lock(&mCommitsMutex);
+
+   // The columns are copied out of the mapping instead of pointing into it: the metadata read later is written in the
+   // table, and the file is replaced when it's saved again, which Windows doesn't allow while the file is mapped. The
+   // mapping still avoids reading the file through a buffer, and each column is copied in a single pass.
+   const auto restored = mCommits.load(data, size, key);
+
+   file.unmap(data);
 
-   return std::find_if(mCommitsCache.crbegin() + startEndPos, mCommitsCache.crend(),
-                       [text](const CommitInfo &info) { return info.contains(text); });
+   if (restored)
+   {
+      mInitialized = true;
+      mConfigured = false;
+
+      QLog_Debug("Cache", QString("Restored {%1} revisions from {%2}.").arg(mCommits.count()).arg(fileName));
+   }
+   else
+      mCommits.clear();
+
+   publishSnapshot(0);
+
+   return restored;
 }
 
-CommitInfo GitCache::searchCommitInfo(const QString &text, int startingPoint, bool reverse)
+CommitInfo GitCache::commitInfo(int row)
 {
    QMutexLocker lock(&mCommitsMutex);
-   CommitInfo commit;
 
-   if (!reverse)
-   {
-      auto commitIter = searchCommit(text, startingPoint);
+   return mCommits.commit(row);
+}
 
-      if (commitIter == mCommitsCache.constEnd())
-         commitIter = searchCommit(text);
+int GitCache::searchCommit(const CommitTable &commits, const QString &text, const int startingPoint) const
+{
+   const auto totalCommits = commits.count();
 
-      if (commitIter != mCommitsCache.constEnd())
-         commit = *commitIter;
+   for (auto row = std::max(startingPoint, 0); row < totalCommits; ++row)
+   {
+      if (commits.contains(row, text))
+         return row;
    }
-   else
+
+   return -1;
+}
+
+int GitCache::reverseSearchCommit(const CommitTable &commits, const QString &text, int startingPoint) const
+{
+   const auto lastRow = commits.count() - 1;
+   const auto startingRow = startingPoint > 0 ? std::min(startingPoint - 2, lastRow) : lastRow;
+
+   for (auto row = startingRow; row >= 0; --row)
    {
-      auto commitIter = reverseSearchCommit(text, startingPoint);
+      if (commits.contains(row, text))
+         return row;
+   }
+
+   return -1;
+}
 
-      if (commitIter == mCommitsCache.crend())
-         commitIter = reverseSearchCommit(text);
+CommitInfo GitCache::searchCommitInfo(const QString &text, int startingPoint, bool reverse)
+{
+   // The search reads the published snapshot, so it doesn't wait for the loader.
+   const auto commits = snapshot();
+   auto row = -1;
 
-      if (commitIter != mCommitsCache.crend())
-         commit = *commitIter;
+   if (!mSearchIndex->find(text, *commits, startingPoint, reverse, &row))
+   {
+      row = reverse ? reverseSearchCommit(*commits, text, startingPoint) : searchCommit(*commits, text, startingPoint);
+
+      if (row == -1)
+         row = reverse ? reverseSearchCommit(*commits, text) : searchCommit(*commits, text);
    }
 
-   return commit;
+   return commits->commit(row);
+}
+
+bool GitCache::searchIndexedCommitInfo(const QString &text, int startingPoint, CommitInfo *commit)
+{
+   const auto commits = snapshot();
+   auto row = -1;
+
+   if (!mSearchIndex->find(text, *commits, startingPoint, false, &row))
+      return false;
+
+   *commit = commits->commit(row);
+
+   return true;
 }
 
 CommitInfo GitCache::commitInfo(const QString &sha)
 {
+   const auto row = commitRow(sha);
+
    QMutexLocker lock(&mCommitsMutex);
 
-   if (!sha.isEmpty())
-   {
-      const auto c = mCommitsMap.value(sha, nullptr);
+   return mCommits.commit(row);
+}
 
-      if (!c)
-      {
-         const auto shas = mCommitsMap.keys();
-         const auto it = std::find_if(shas.cbegin(), shas.cend(),
-                                      [sha](const QString &shaToCompare) { return shaToCompare.startsWith(sha); });
+int GitCache::commitRow(const QString &sha, bool *ambiguous) const
+{
+   QMutexLocker lock(&mCommitsMutex);
 
-         if (it != shas.cend())
-            return *mCommitsMap.value(*it);
+   if (ambiguous)
+      *ambiguous = false;
 
-         return CommitInfo();
-      }
+   if (sha.isEmpty())
+      return -1;
 
-      return *c;
-   }
+   if (const auto row = mCommits.row(sha); row != -1)
+      return row;
 
-   return CommitInfo();
+   auto isAmbiguous = false;
+   const auto row = mCommits.rowByPrefix(sha, &isAmbiguous);
+
+   if (isAmbiguous)
+      QLog_Warning("Cache", QString("The short SHA {%1} is ambiguous.").arg(sha));
+
+   if (ambiguous)
+      *ambiguous = isAmbiguous;
+
+   return row;
 }
 
 std::optional<RevisionFiles> GitCache::revisionFile(const QString &sha1, const QString &sha2) const
 {
    QMutexLocker lock(&mRevisionsMutex);
 
-   const auto iter = mRevisionFilesMap.constFind(qMakePair(sha1, sha2));
+   return mRevisionFilesMap.find(qMakePair(sha1, sha2));
+}
+
+bool GitCache::hasRevisionFiles(const QString &sha1, const QString &sha2) const
+{
+   QMutexLocker lock(&mRevisionsMutex);
+
+   return mRevisionFilesMap.contains(qMakePair(sha1, sha2));
+}
 
-   if (iter != mRevisionFilesMap.cend())
-      return *iter;
+void GitCache::setRevisionFilesBudget(qint64 bytes)
+{
+   QMutexLocker lock(&mRevisionsMutex);
 
-   return std::nullopt;
+   mRevisionFilesMap.setBudget(bytes);
 }
 
 void GitCache::clearReferences()
 {
    QMutexLocker lock(&mReferencesMutex);
    mReferences.clear();
-   mReferences.squeeze();
+
+   publishReferencedRows();
 }
 
-void GitCache::insertWipRevision(const QString parentSha, const RevisionFiles &files)
+void GitCache::beginReferencesUpdate()
+{
+   QMutexLocker lock(&mReferencesMutex);
+
+   ++mReferencesUpdates;
+}
+
+void GitCache::endReferencesUpdate()
+{
+   QMutexLocker lock(&mReferencesMutex);
+
+   --mReferencesUpdates;
+
+   publishReferencedRows();
+}
+
+bool GitCache::insertWipRevision(const QString parentSha, const RevisionFiles &files)
 {
    auto newParentSha = parentSha;
 
@@ -183,22 +508,19 @@ void GitCache::insertWipRevision(const QString parentSha, const RevisionFiles &f
    if (!newParentSha.isEmpty())
       parents.append(newParentSha);
 
-   if (mLanes.isEmpty())
-      mLanes.init(ZERO_SHA);
-
    const auto log = files.count() == mUntrackedFiles.count() ? tr("No local changes") : tr("Local changes");
    CommitInfo c(ZERO_SHA, parents, std::chrono::seconds(QDateTime::currentSecsSinceEpoch()), log);
-   calculateLanes(c);
 
-   if (!mCommitsCache.isEmpty())
-      c.setLanes(mCommitsCache[0].lanes());
-
-   if (mCommitsCache[0].sha != ZERO_SHA)
-      mCommitsCache.prepend(std::move(c));
+   if (mCommits.isEmpty())
+      mCommits.append(c);
+   else if (mCommits.sha(0) != ZERO_SHA)
+      mCommits.insert(0, c);
+   else if (mCommits.firstParent(0) != newParentSha || mCommits.shortLog(0) != log)
+      mCommits.update(0, c);
    else
-      mCommitsCache[0] = std::move(c);
+      return false; // The files are not part of the table: the snapshot doesn't change.
 
-   mCommitsMap.insert(ZERO_SHA, &mCommitsCache[0]);
+   return true;
 }
 
 bool GitCache::insertRevisionFiles(const QString &sha1, const QString &sha2, const RevisionFiles &file)
@@ -214,12 +536,12 @@ bool GitCache::insertRevisionFile(const QString &sha1, const QString &sha2, cons
    const auto emptyShas = !sha1.isEmpty() && !sha2.isEmpty();
    const auto isWip = sha1 == ZERO_SHA;
 
-   if ((emptyShas || isWip) && mRevisionFilesMap.value(key) != file)
+   // As a missing entry reads as an empty list, empty lists are only stored to replace another one.
+   if ((emptyShas || isWip) && (file != RevisionFiles() || mRevisionFilesMap.contains(key))
+       && mRevisionFilesMap.insert(key, file, isWip))
    {
       QLog_Debug("Cache", QString("Adding the revisions files between {%1} and {%2}.").arg(sha1, sha2));
 
-      mRevisionFilesMap.insert(key, file);
-
       return true;
    }
 
@@ -232,68 +554,60 @@ void GitCache::insertReference(const QString &sha, References::Type type, const
 
    QLog_Trace("Cache", QString("Adding a new reference with SHA {%1}.").arg(sha));
 
-   mReferences[sha].addReference(type, reference);
+   if (mReferences.insert(Oid::fromString(sha), type, reference))
+      publishReferencedRows();
 }
 
 void GitCache::deleteReference(const QString &sha, References::Type type, const QString &reference)
 {
    QMutexLocker lock(&mReferencesMutex);
 
-   mReferences[sha].removeReference(type, reference);
+   if (mReferences.remove(Oid::fromString(sha), type, reference))
+      publishReferencedRows();
 }
 
 bool GitCache::hasReferences(const QString &sha)
 {
    QMutexLocker lock(&mReferencesMutex);
 
-   return mReferences.contains(sha) && !mReferences.value(sha).isEmpty();
+   return mReferences.hasReferences(Oid::fromString(sha));
+}
+
+bool GitCache::hasReferences(int row) const
+{
+   // It's read for every row painted, so it reads the published bits instead of locking the references.
+   const auto rows = mReferencedRows.load();
+
+   return row >= 0 && row < rows->size() && rows->testBit(row);
 }
 
 QStringList GitCache::getReferences(const QString &sha, References::Type type)
 {
    QMutexLocker lock(&mReferencesMutex);
 
-   return mReferences.value(sha).getReferences(type);
+   return mReferences.references(Oid::fromString(sha), type);
 }
 
 QString GitCache::getShaOfReference(const QString &referenceName, References::Type type) const
 {
    QMutexLocker lock(&mReferencesMutex);
 
-   for (auto iter = mReferences.cbegin(); iter != mReferences.cend(); ++iter)
-   {
-      const auto references = iter.value().getReferences(type);
-
-      for (const auto &reference : references)
-         if (reference == referenceName)
-            return iter.key();
-   }
+   const auto oid = mReferences.oid(referenceName, type);
 
-   return QString();
+   return oid ? oid->toString() : QString();
 }
 
 void GitCache::reloadCurrentBranchInfo(const QString &currentBranch, const QString &currentSha)
 {
    QMutexLocker lock(&mReferencesMutex);
 
-   const auto lastItem = mReferences.end();
-   for (auto ref = mReferences.begin(); ref != lastItem; ++ref)
-   {
-      if (ref.value().getReferences(References::Type::LocalBranch).contains(currentBranch))
-      {
-         ref.value().removeReference(References::Type::LocalBranch, currentBranch);
-
-         const auto key = ref.key();
-
-         if (mReferences.value(key).isEmpty())
-            mReferences.remove(key);
-
-         break;
-      }
-   }
+   if (const auto oid = mReferences.oid(currentBranch, References::Type::LocalBranch))
+      mReferences.remove(*oid, References::Type::LocalBranch, currentBranch);
 
    if (!currentBranch.isEmpty())
-      mReferences[currentSha].addReference(References::Type::LocalBranch, currentBranch);
+      mReferences.insert(Oid::fromString(currentSha), References::Type::LocalBranch, currentBranch);
+
+   publishReferencedRows();
 }
 
 bool GitCache::updateWipCommit(const QString &parentSha, const RevisionFiles &files)
@@ -303,7 +617,9 @@ bool GitCache::updateWipCommit(const QString &parentSha, const RevisionFiles &fi
 
    if (mConfigured)
    {
-      insertWipRevision(parentSha, files);
+      if (insertWipRevision(parentSha, files))
+         publishSnapshot(0);
+
       return true;
    }
 
@@ -315,28 +631,15 @@ void GitCache::insertCommit(CommitInfo commit)
    QMutexLocker lock2(&mCommitsMutex);
 
    const auto sha = commit.sha;
-   const auto parentSha = commit.firstParent();
-
-   commit.setLanes({ LaneType::ACTIVE });
 
-   mCommitsCache[0].setParents({ sha });
-   mCommitsCache.insert(1, std::move(commit));
-   mCommitsCache[1].appendChild(&mCommitsCache[0]);
+   mCommits.insert(1, commit);
 
-   mCommitsMap.clear();
+   auto wip = mCommits.commit(0);
+   wip.setParents({ sha });
 
-   const auto totalCommits = mCommitsCache.count();
-   mCommitsMap.reserve(totalCommits);
+   mCommits.update(0, wip);
 
-   auto count = 0;
-   for (auto &commit : mCommitsCache)
-   {
-      commit.pos = count;
-      mCommitsMap[commit.sha] = &commit;
-   }
-
-   mCommitsMap[parentSha]->removeChild(mCommitsMap[ZERO_SHA]);
-   mCommitsMap[parentSha]->appendChild(mCommitsMap[sha]);
+   publishSnapshot(0);
 }
 
 void GitCache::updateCommit(const QString &oldSha, CommitInfo newCommit)
@@ -344,20 +647,12 @@ void GitCache::updateCommit(const QString &oldSha, CommitInfo newCommit)
    QMutexLocker lock(&mCommitsMutex);
    QMutexLocker lock2(&mRevisionsMutex);
 
-   auto &oldCommit = mCommitsMap[oldSha];
-   const auto oldCommitParens = oldCommit->parents();
    const auto newCommitSha = newCommit.sha;
-   const auto newPos = newCommit.pos;
+   const auto row = mCommits.row(oldSha);
 
-   mCommitsCache[newPos] = std::move(newCommit);
-   mCommitsMap.remove(oldSha);
-   mCommitsMap.insert(newCommitSha, &mCommitsCache[newPos]);
+   mCommits.update(row, newCommit);
 
-   for (const auto &parent : oldCommitParens)
-   {
-      mCommitsMap[parent]->removeChild(oldCommit);
-      mCommitsMap[parent]->appendChild(mCommitsMap[newCommitSha]);
-   }
+   publishSnapshot(row);
 
    const auto tags = getReferences(oldSha, References::Type::LocalTag);
    for (const auto &tag : tags)
@@ -374,42 +669,15 @@ void GitCache::updateCommit(const QString &oldSha, CommitInfo newCommit)
    }
 }
 
-void GitCache::calculateLanes(CommitInfo &c)
-{
-   const auto sha = c.sha;
-
-   QLog_Trace("Cache", QString("Updating the lanes for SHA {%1}.").arg(sha));
-
-   bool isDiscontinuity;
-   bool isFork = mLanes.isFork(sha, isDiscontinuity);
-   bool isMerge = c.parentsCount() > 1;
-
-   if (isDiscontinuity)
-      mLanes.changeActiveLane(sha);
-
-   if (isFork)
-      mLanes.setFork(sha);
-   if (isMerge)
-      mLanes.setMerge(c.parents());
-   if (c.parentsCount() == 0)
-      mLanes.setInitial();
-
-   const auto lanes = mLanes.getLanes();
-
-   resetLanes(c, isFork);
-
-   c.setLanes(std::move(lanes));
-}
-
 bool GitCache::pendingLocalChanges()
 {
    QMutexLocker lock(&mCommitsMutex);
 
    auto localChanges = false;
 
-   if (const auto commit = mCommitsMap.value(ZERO_SHA, nullptr))
+   if (mCommits.row(ZERO_SHA) == 0)
    {
-      if (const auto rf = revisionFile(ZERO_SHA, commit->firstParent()); rf)
+      if (const auto rf = revisionFile(ZERO_SHA, mCommits.firstParent(0)); rf)
          localChanges = rf.value().count() - mUntrackedFiles.count() > 0;
    }
 
@@ -420,9 +688,12 @@ QVector<QPair<QString, QStringList>> GitCache::getBranches(References::Type type
 {
    QMutexLocker lock(&mReferencesMutex);
    QVector<QPair<QString, QStringList>> branches;
+   const auto references = mReferences.references(type);
 
-   for (auto iter = mReferences.cbegin(); iter != mReferences.cend(); ++iter)
-      branches.append(QPair<QString, QStringList>(iter.key(), iter.value().getReferences(type)));
+   branches.reserve(references.count());
+
+   for (const auto &reference : references)
+      branches.append(QPair<QString, QStringList>(reference.first.toString(), reference.second));
 
    return branches;
 }
@@ -432,13 +703,14 @@ QMap<QString, QString> GitCache::getTags(References::Type tagType) const
    QMutexLocker lock(&mReferencesMutex);
 
    QMap<QString, QString> tags;
+   const auto references = mReferences.references(tagType);
 
-   for (auto iter = mReferences.cbegin(); iter != mReferences.cend(); ++iter)
+   for (const auto &reference : references)
    {
-      const auto tagNames = iter->getReferences(tagType);
+      const auto sha = reference.first.toString();
 
-      for (const auto &tag : tagNames)
-         tags[tag] = iter.key();
+      for (const auto &tag : reference.second)
+         tags[tag] = sha;
    }
 
    return tags;
@@ -448,43 +720,61 @@ void GitCache::updateTags(QMap<QString, QString> remoteTags)
 {
    const auto end = remoteTags.cend();
 
+   beginReferencesUpdate();
+
    for (auto iter = remoteTags.cbegin(); iter != end; ++iter)
       insertReference(iter.value(), References::Type::RemoteTag, iter.key());
 
-   emit signalCacheUpdated();
-}
-
-void GitCache::resetLanes(const CommitInfo &c, bool isFork)
-{
-   const auto nextSha = c.parentsCount() == 0 ? QString() : c.firstParent();
+   endReferencesUpdate();
 
-   mLanes.nextParent(nextSha);
-
-   if (c.parentsCount() > 1)
-      mLanes.afterMerge();
-   if (isFork)
-      mLanes.afterFork();
-   if (mLanes.isBranch())
-      mLanes.afterBranch();
+   emit signalCacheUpdated();
 }
 
 void GitCache::clearInternalData()
 {
-   mCommitsMap.clear();
-   mCommitsMap.squeeze();
+   mCommits.clear();
    mReferences.clear();
    mRevisionFilesMap.clear();
-   mRevisionFilesMap.squeeze();
+   mSearchIndex->clear();
    mUntrackedFiles.clear();
    mUntrackedFiles.squeeze();
-   mLanes.clear();
-   mReferences.clear();
-   mReferences.squeeze();
 }
 
 int GitCache::commitCount() const
 {
-   return mCommitsCache.count();
+   return snapshot()->count();
+}
+
+std::shared_ptr<const CommitTable> GitCache::snapshot() const
+{
+   return mSnapshot.load();
+}
+
+void GitCache::publishSnapshot(int firstChangedRow)
+{
+   // The copy only shares the columns of the table. Readers keep the previous snapshot alive for as long as they use
+   // it and the next change to mCommits detaches the columns it writes.
+   auto snapshot = std::make_shared<const CommitTable>(mCommits);
+
+   mSnapshotOutdated = false;
+
+   mSearchIndex->update(snapshot);
+
+   // The rows with references are stored with the snapshot under the lock, so a change of the references made
+   // meanwhile can't publish the rows of the previous one after it.
+   QMutexLocker lock(&mReferencesMutex);
+
+   mReferences.indexRows(snapshot, firstChangedRow);
+   mSnapshot.store(std::move(snapshot));
+
+   publishReferencedRows();
+}
+
+void GitCache::publishReferencedRows()
+{
+   // The references are changed one by one, so while they are updated together they are only published at the end.
+   if (mReferencesUpdates == 0)
+      mReferencedRows.store(std::make_shared<const QBitArray>(mReferences.rowsWithReferences()));
 }
 
 void GitCache::setUntrackedFilesList(QVector<QString> untrackedFiles)
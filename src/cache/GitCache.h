@@ -23,18 +23,24 @@
  ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  ***************************************************************************************/
 
+#include <AtomicSharedPtr.h>
 #include <CommitInfo.h>
+#include <CommitTable.h>
 #include <GitExecResult.h>
+#include <ReferenceIndex.h>
 #include <RevisionFiles.h>
-#include <lanes.h>
+#include <RevisionFilesCache.h>
 
-#include <QHash>
+#include <QBitArray>
 #include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QSharedPointer>
 
+#include <memory>
 #include <optional>
 
+class CommitSearchIndex;
 struct WipRevisionInfo;
 
 class GitCache : public QObject
@@ -43,6 +49,11 @@ class GitCache : public QObject
 
 signals:
    void signalCacheUpdated();
+   void signalMetadataRequested();
+   /**
+    * @brief Emitted when the search index is up to date with the last published snapshot.
+    */
+   void signalSearchIndexUpdated();
 
 public:
    struct LocalBranchDistances
@@ -56,20 +67,59 @@ public:
 
    int commitCount() const;
 
+   /**
+    * @brief Returns the last published version of the commit history. The snapshot is immutable and can be read
+    * without waiting for the loader while it keeps modifying the cache: a new one is published after every change.
+    *
+    * @return The commit history snapshot.
+    */
+   std::shared_ptr<const CommitTable> snapshot() const;
+
    CommitInfo commitInfo(const QString &sha);
+   int commitRow(const QString &sha, bool *ambiguous = nullptr) const;
    CommitInfo commitInfo(int row);
+   /**
+    * @brief Asks for the author, committer and message of the rows loaded without them, starting at @p row. The loader
+    * reads them in the background and updates the cache. It can be called from any thread.
+    *
+    * @param row The first row that needs the metadata.
+    */
+   void requestMetadata(int row);
+   /**
+    * @brief Asks the loader to read the metadata of the whole history in the background, so the search can find any
+    * commit and not only the ones that have been shown. It can be called from any thread.
+    */
+   void requestSearchMetadata();
    CommitInfo searchCommitInfo(const QString &text, int startingPoint = 0, bool reverse = false);
+   /**
+    * @brief Searches the commits like @ref searchCommitInfo, but only through the search index so it never scans the
+    * history.
+    *
+    * @param commit Filled with the commit found, invalid if no commit matches.
+    * @return True if the index served the search, false if it's still indexing the last snapshot.
+    */
+   bool searchIndexedCommitInfo(const QString &text, int startingPoint, CommitInfo *commit);
    bool updateWipCommit(const QString &parentSha, const RevisionFiles &files);
    void insertCommit(CommitInfo commit);
    void updateCommit(const QString &oldSha, CommitInfo newCommit);
 
    bool insertRevisionFiles(const QString &sha1, const QString &sha2, const RevisionFiles &file);
    std::optional<RevisionFiles> revisionFile(const QString &sha1, const QString &sha2) const;
+   bool hasRevisionFiles(const QString &sha1, const QString &sha2) const;
+
+   /**
+    * @brief Sets the memory that the lists of files changed between commits can take. The lists used least recently
+    * are dropped when they go over it, except the one of the WIP.
+    *
+    * @param bytes The budget in bytes.
+    */
+   void setRevisionFilesBudget(qint64 bytes);
 
    void clearReferences();
    void insertReference(const QString &sha, References::Type type, const QString &reference);
    void deleteReference(const QString &sha, References::Type type, const QString &reference);
    bool hasReferences(const QString &sha);
+   bool hasReferences(int row) const;
    QStringList getReferences(const QString &sha, References::Type type);
    QString getShaOfReference(const QString &referenceName, References::Type type) const;
    void reloadCurrentBranchInfo(const QString &currentBranch, const QString &currentSha);
@@ -89,27 +139,57 @@ private:
 
    bool mInitialized = false;
    bool mConfigured = true;
-   Lanes mLanes;
    QVector<QString> mUntrackedFiles;
 
    mutable QMutex mCommitsMutex;
-   QVector<CommitInfo> mCommitsCache;
-   QHash<QString, CommitInfo *> mCommitsMap;
+   CommitTable mCommits;
+
+   AtomicSharedPtr<const CommitTable> mSnapshot;
+   std::unique_ptr<CommitSearchIndex> mSearchIndex; // Indexes every published snapshot in the background.
 
    mutable QMutex mRevisionsMutex;
-   QHash<QPair<QString, QString>, RevisionFiles> mRevisionFilesMap;
+   mutable RevisionFilesCache mRevisionFilesMap; // A lookup updates the order of use.
 
    mutable QMutex mReferencesMutex;
-   QHash<QString, References> mReferences;
+   ReferenceIndex mReferences;
+   AtomicSharedPtr<const QBitArray> mReferencedRows; // The rows of the snapshot with references, read without locking.
+   int mReferencesUpdates = 0;
+
+   QMutex mMetadataMutex;
+   QSet<QString> mRequestedMetadata;
+   QStringList mPendingMetadata;
+   int mPrefetchRow = 0; // Window of rows after the ones shown that is read in the background.
+   int mPrefetchEnd = 0;
+   int mSearchMetadataRow = -1; // First row not visited by the read of the whole history, -1 if not requested.
+   int mMetadataFirstRow = -1; // Range of the rows whose metadata was read since the last call to publishMetadata().
+   int mMetadataLastRow = -1;
+   bool mSnapshotOutdated = false;
 
    void setup(const QString &parentSha, const RevisionFiles &files, QVector<CommitInfo> commits);
+   void beginSetup(const QString &parentSha, const RevisionFiles &files);
+   void appendCommits(QVector<CommitInfo> commits, bool metadataPending = false);
+   void endSetup();
+   void setupTopology(const QString &parentSha, const RevisionFiles &files, QVector<CommitInfo> commits);
+   QStringList takeMetadataRequests();
+   QStringList takeBackgroundMetadataRequests(int count);
+   void updateMetadata(const QVector<CommitInfo> &commits);
+   bool publishMetadata(int *firstRow, int *lastRow);
    void setConfigurationDone() { mConfigured = true; }
+   void beginReferencesUpdate();
+   void endReferencesUpdate();
 
    bool insertRevisionFile(const QString &sha1, const QString &sha2, const RevisionFiles &file);
-   void insertWipRevision(const QString parentSha, const RevisionFiles &files);
-   void calculateLanes(CommitInfo &c);
-   auto searchCommit(const QString &text, int startingPoint = 0) const;
-   auto reverseSearchCommit(const QString &text, int startingPoint = 0) const;
-   void resetLanes(const CommitInfo &c, bool isFork);
+   bool insertWipRevision(const QString parentSha, const RevisionFiles &files);
+   void resetCommits(const QString &parentSha, const RevisionFiles &files, int totalCommits);
+   void addCommits(QVector<CommitInfo> commits);
+   void prependCommits(const QString &parentSha, const RevisionFiles &files, QVector<CommitInfo> commits);
+   QStringList tips() const;
+   QStringList boundaryParents() const;
+   bool saveCommits(const QString &fileName, const QByteArray &key) const;
+   bool restoreCommits(const QString &fileName, const QByteArray &key);
+   int searchCommit(const CommitTable &commits, const QString &text, int startingPoint = 0) const;
+   int reverseSearchCommit(const CommitTable &commits, const QString &text, int startingPoint = 0) const;
    void clearInternalData();
+   void publishSnapshot(int firstChangedRow);
+   void publishReferencedRows();
 };
@@ -1,5 +1,7 @@
 #include "GitRepoLoader.h"
 
+#include <CommitGraphReader.h>
+#include <CommitObjectReader.h>
 #include <GitBase.h>
 #include <GitBranches.h>
 #include <GitCache.h>
@@ -9,14 +11,154 @@
 #include <GitRequestorProcess.h>
 #include <GitTags.h>
 #include <GitWip.h>
+#include <ReferencesReader.h>
 
 #include <QLogger.h>
 
 #include <QDir>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <algorithm>
 
 using namespace QLogger;
 
 static const char *GIT_LOG_FORMAT("%m%HX%P%n%cn<%ce>%n%an<%ae>%n%at%n%s%n%b ");
+static const int FIRST_LOG_BATCH = 500;
+static const int MAX_LOG_BATCH = 50000;
+static const int MIN_RECORDS_PER_THREAD = 2000;
+static const int MAX_INCREMENTAL_TIPS = 500;
+static const int BACKGROUND_METADATA_BATCH = 500;
+static const int METADATA_PUBLISH_INTERVAL_MS = 200;
+static const char *COMMITS_CACHE_FILE("/GitQlientCommits.cache");
+static const int CACHE_SAVE_DELAY_MS = 2000;
+
+namespace
+{
+/**
+ * @brief Parses the NUL separated records of a git log output. The record boundaries are found once and, when there
+ * are enough of them, the records are parsed in parallel chunks. The valid commits are returned in the log order.
+ *
+ * @param log The git log output.
+ * @param includeTail Whether the data after the last NUL is a complete record (end of the output) or not.
+ * @param consumed If not null, it gets the amount of bytes of @p log that have been parsed.
+ */
+QVector<CommitInfo> parseLogRecords(const QByteArray &log, bool includeTail, qsizetype *consumed = nullptr)
+{
+   QVector<QPair<qsizetype, qsizetype>> records;
+   qsizetype start = 0;
+   qsizetype end;
+
+   while ((end = log.indexOf('\000', start)) != -1)
+   {
+      records.append({ start, end - start });
+      start = end + 1;
+   }
+
+   if (includeTail && start < log.size())
+   {
+      records.append({ start, log.size() - start });
+      start = log.size();
+   }
+
+   if (consumed)
+      *consumed = start;
+
+   const auto parseRange = [&log, &records](qsizetype first, qsizetype last) {
+      QVector<CommitInfo> commits;
+      commits.reserve(last - first);
+
+      for (auto i = first; i < last; ++i)
+      {
+         const auto &record = records.at(i);
+
+         if (auto commit = CommitInfo { QByteArray::fromRawData(log.constData() + record.first, record.second) };
+             commit.isValid())
+         {
+            commits.append(std::move(commit));
+         }
+      }
+
+      return commits;
+   };
+
+   const auto totalRecords = records.count();
+   const auto chunks = std::clamp<qsizetype>(totalRecords / MIN_RECORDS_PER_THREAD, 1,
+                                             std::max(1, QThread::idealThreadCount()));
+
+   if (chunks == 1)
+      return parseRange(0, totalRecords);
+
+   QVector<QVector<CommitInfo>> results(chunks);
+   const auto chunkSize = (totalRecords + chunks - 1) / chunks;
+
+   QThreadPool pool;
+   pool.setMaxThreadCount(static_cast<int>(chunks));
+
+   for (qsizetype chunk = 0; chunk < chunks; ++chunk)
+   {
+      pool.start([&results, &parseRange, chunk, chunkSize, totalRecords]() {
+         results[chunk] = parseRange(chunk * chunkSize, std::min((chunk + 1) * chunkSize, totalRecords));
+      });
+   }
+
+   pool.waitForDone();
+
+   QVector<CommitInfo> commits;
+   commits.reserve(totalRecords);
+
+   for (auto &result : results)
+   {
+      for (auto &commit : result)
+         commits.append(std::move(commit));
+   }
+
+   return commits;
+}
+
+/**
+ * @brief Parses the lines of the topology log (%at %H %P): the author date, the SHA and the parents of the commits. The
+ * commits only have the topology and the date.
+ *
+ * @param output The git log output.
+ * @param includeTail Whether the data after the last new line is a complete line (end of the output) or not.
+ * @param consumed If not null, it gets the amount of bytes of @p output that have been parsed.
+ */
+QVector<CommitInfo> parseRevListLines(const QByteArray &output, bool includeTail, qsizetype *consumed = nullptr)
+{
+   QVector<CommitInfo> commits;
+   qsizetype start = 0;
+
+   while (start < output.size())
+   {
+      auto end = output.indexOf('\n', start);
+
+      if (end == -1)
+      {
+         if (!includeTail)
+            break;
+
+         end = output.size();
+      }
+
+      // The root commits end with the separator of their empty list of parents.
+      if (const auto fields = QString::fromLatin1(output.constData() + start, end - start).trimmed().split(' ');
+          fields.count() >= 2)
+      {
+         commits.append(CommitInfo(fields.at(1), fields.mid(2), std::chrono::seconds(fields.at(0).toLongLong()),
+                                   QString()));
+      }
+
+      start = std::min(end + 1, output.size());
+   }
+
+   if (consumed)
+      *consumed = start;
+
+   return commits;
+}
+}
 
 GitRepoLoader::GitRepoLoader(QSharedPointer<GitBase> gitBase, QSharedPointer<GitCache> cache,
                              const QSharedPointer<GitQlientSettings> &settings, QObject *parent)
@@ -25,8 +167,21 @@ GitRepoLoader::GitRepoLoader(QSharedPointer<GitBase> gitBase, QSharedPointer<Git
    , mRevCache(std::move(cache))
    , mSettings(settings)
    , mGitTags(new GitTags(mGitBase))
+   , mObjectReader(new CommitObjectReader(this))
+   , mMetadataTimer(new QTimer(this))
+   , mCacheSaveTimer(new QTimer(this))
 {
+   mMetadataTimer->setSingleShot(true);
+   mMetadataTimer->setInterval(METADATA_PUBLISH_INTERVAL_MS);
+   mCacheSaveTimer->setSingleShot(true);
+   mCacheSaveTimer->setInterval(CACHE_SAVE_DELAY_MS);
+
+   connect(mMetadataTimer, &QTimer::timeout, this, &GitRepoLoader::publishMetadata);
+   connect(mCacheSaveTimer, &QTimer::timeout, this, &GitRepoLoader::saveCommitsCache);
    connect(mGitTags.get(), &GitTags::remoteTagsReceived, mRevCache.get(), &GitCache::updateTags);
+   connect(mRevCache.get(), &GitCache::signalMetadataRequested, this, &GitRepoLoader::requestMetadata);
+   connect(mObjectReader, &CommitObjectReader::commitsRead, this, &GitRepoLoader::processMetadata);
+   connect(this, &GitRepoLoader::cancelAllProcesses, mObjectReader, &CommitObjectReader::stop);
 }
 
 void GitRepoLoader::cancelAll()
@@ -122,6 +277,56 @@ void GitRepoLoader::loadAll()
    }
 }
 
+void GitRepoLoader::loadMoreRevisions()
+{
+   // A load in progress will start the paging again when it finishes.
+   if (mLocked || !mMoreRevisions || mPageArgs.isEmpty())
+      return;
+
+   // The next page starts at the parents of the loaded commits that are not loaded yet, and at the tips of the paged
+   // revisions that didn't make it to the previous pages, like the branches older than the last commit loaded. The log
+   // orders never show a commit before its children, so none of the commits reachable from these is loaded. Unlike
+   // skipping the commits already listed, it continues the same history even if the branches changed meanwhile.
+   auto starts = mRevCache->boundaryParents();
+
+   if (const auto ret = mGitBase->run(QString("git rev-list --no-walk=unsorted %1").arg(mPageRevisions)); ret.success)
+   {
+      const auto commits = mRevCache->snapshot();
+      const auto tips = ret.output.split('\n');
+
+      for (const auto &line : tips)
+      {
+         if (const auto tip = line.trimmed(); !tip.isEmpty() && commits->row(tip) == -1 && !starts.contains(tip))
+            starts.append(tip);
+      }
+   }
+
+   if (starts.isEmpty())
+   {
+      mMoreRevisions = false;
+
+      emit signalMoreRevisionsAvailable(false);
+      return;
+   }
+
+   QLog_Debug("Git",
+              QString("Loading the revisions after the first {%1}, from {%2} commits.")
+                  .arg(mPagedCommits)
+                  .arg(starts.count()));
+
+   mLocked = true;
+   mPageLoad = true;
+   mTopologyOnly = true;
+   mIncrementalLoad = false;
+
+   // There can be many commits when all the branches are shown, so they are given through the standard input.
+   auto args = mPageArgs;
+   args.append(QString("--max-count=%1").arg(mPageSize));
+   args.append("--stdin");
+
+   requestRevisionsStream(args, starts);
+}
+
 bool GitRepoLoader::configureRepoDirectory()
 {
    QLog_Debug("Git", "Configuring repository directory.");
@@ -133,6 +338,16 @@ bool GitRepoLoader::configureRepoDirectory()
       QDir d(QString("%1/%2").arg(mGitBase->getWorkingDir(), ret.output.trimmed()));
       mGitBase->setWorkingDir(d.absolutePath());
 
+      // The commits table stores SHA-1 ids. Old Git versions don't know the option, and only support SHA-1.
+      const auto format = mGitBase->run("git rev-parse --show-object-format");
+
+      if (format.success && format.output.trimmed() != QString("sha1"))
+      {
+         QLog_Error("Git",
+                    QString("The object format {%1} of the repository is not supported.").arg(format.output.trimmed()));
+         return false;
+      }
+
       return true;
    }
 
@@ -143,6 +358,16 @@ void GitRepoLoader::requestReferences()
 {
    QLog_Debug("Git", "Loading references...");
 
+   if (ReferencesReader reader(mGitBase->getGitDir()); reader.read(*mRevCache->snapshot()))
+   {
+      QLog_Debug("Git", "References read from the git directory.");
+
+      updateReferences(reader.references(), reader.headSha());
+
+      mGitTags->getRemoteTags();
+      return;
+   }
+
    mRefRequestor = new GitRequestorProcess(mGitBase->getWorkingDir());
    connect(mRefRequestor, &GitRequestorProcess::procDataReady, this, &GitRepoLoader::processReferences);
    connect(this, &GitRepoLoader::cancelAllProcesses, mRefRequestor, &AGitProcess::onCancel);
@@ -154,10 +379,7 @@ void GitRepoLoader::requestReferences()
 
 void GitRepoLoader::processReferences(QByteArray ba)
 {
-   if (mRefreshReferences)
-      mRevCache->clearReferences();
-
-   QString prevRefSha;
+   QVector<ReferencesReader::Reference> references;
    const auto referencesList = ba.split('\n');
 
    for (const auto &reference : referencesList)
@@ -191,13 +413,27 @@ void GitRepoLoader::processReferences(QByteArray ba)
             else
                continue;
 
-            mRevCache->insertReference(revSha, type, name);
+            references.append({ revSha, type, name });
          }
-         prevRefSha = revSha;
       }
    }
 
-   mRevCache->reloadCurrentBranchInfo(mGitBase->getCurrentBranch(), mGitBase->getLastCommit().output.trimmed());
+   updateReferences(references, mGitBase->getLastCommit().output.trimmed());
+}
+
+void GitRepoLoader::updateReferences(const QVector<ReferencesReader::Reference> &references, const QString &headSha)
+{
+   // The view reads the rows with references from the last version published: it's published once all are added.
+   mRevCache->beginReferencesUpdate();
+
+   if (mRefreshReferences)
+      mRevCache->clearReferences();
+
+   for (const auto &reference : references)
+      mRevCache->insertReference(reference.sha, reference.type, reference.name);
+
+   mRevCache->reloadCurrentBranchInfo(mGitBase->getCurrentBranch(), headSha);
+   mRevCache->endReferencesUpdate();
 
    notifyLoadingFinished();
 }
@@ -207,9 +443,6 @@ void GitRepoLoader::requestRevisions()
    QLog_Debug("Git", "Loading revisions...");
 
    const auto maxCommits = mSettings->localValue("MaxCommits", 0).toInt();
-   const auto commitsToRetrieve = maxCommits != 0 ? QString::fromUtf8("-n %1").arg(maxCommits)
-       : mShowAll                                 ? QString("--all")
-                                                  : mGitBase->getCurrentBranch();
 
    QString order;
 
@@ -229,17 +462,525 @@ void GitRepoLoader::requestRevisions()
          break;
    }
 
-   const auto baseCmd = QString("git log %1 --no-color --log-size --parents --boundary -z --pretty=format:%2 %3")
-                            .arg(order, QString::fromUtf8(GIT_LOG_FORMAT), commitsToRetrieve);
-
    if (!mRevCache->isInitialized())
       emit signalLoadingStarted();
 
-   mRevRequestor = new GitRequestorProcess(mGitBase->getWorkingDir());
-   connect(mRevRequestor, &GitRequestorProcess::procDataReady, this, &GitRepoLoader::processRevisions);
-   connect(this, &GitRepoLoader::cancelAllProcesses, mRevRequestor, &AGitProcess::onCancel);
+   mPageSize = 0;
+   mPagedCommits = 0;
+   mPageArgs.clear();
+   mPageRevisions.clear();
+   mMoreRevisions = false;
+   mCacheSavable = false;
+   mCacheOutdated = false;
+   mCacheSaveTimer->stop();
+
+   emit signalMoreRevisionsAvailable(false);
+
+   QScopedPointer<GitConfig> gitConfig(new GitConfig(mGitBase));
+   const auto ret = gitConfig->getGitValue("log.showSignature");
+
+   if (ret.success && ret.output.contains("true"))
+   {
+      // The GPG output is interleaved with the log, so the signed log can only be processed once it's complete.
+      mLastLogArgs.clear();
+
+      const auto commitsToRetrieve = maxCommits != 0 ? QString::fromUtf8("-n %1").arg(maxCommits)
+          : mShowAll                                 ? QString("--all")
+                                                     : mGitBase->getCurrentBranch();
+
+      const auto baseCmd = QString("git log %1 --no-color --log-size --parents --boundary -z --pretty=format:%2 %3")
+                               .arg(order, QString::fromUtf8(GIT_LOG_FORMAT), commitsToRetrieve);
+
+      mRevRequestor = new GitRequestorProcess(mGitBase->getWorkingDir());
+      connect(mRevRequestor, &GitRequestorProcess::procDataReady, this, &GitRepoLoader::processRevisions);
+      connect(this, &GitRepoLoader::cancelAllProcesses, mRevRequestor, &AGitProcess::onCancel);
+
+      mRevRequestor->run(baseCmd);
+   }
+   else
+   {
+      QStringList args { "log", order, "--no-color", "--log-size", "--parents", "--boundary", "-z",
+                         QString("--pretty=format:%1").arg(QString::fromUtf8(GIT_LOG_FORMAT)) };
+
+      QString revisions;
+
+      if (maxCommits != 0)
+         args.append(QString("--max-count=%1").arg(maxCommits));
+      else
+      {
+         revisions = mShowAll ? QString("--all") : mGitBase->getCurrentBranch();
+
+         if (!revisions.isEmpty())
+            args.append(revisions);
+      }
+
+      // The history is persisted only when it's complete, so it can be restored and refreshed with the delta.
+      mCacheFileKey = maxCommits == 0 && !revisions.isEmpty() ? cacheFileKey(order, revisions) : QByteArray();
+
+      if (!mCacheFileKey.isEmpty() && !mRevCache->isInitialized()
+          && mRevCache->restoreCommits(mGitBase->getGitDir() + QString::fromUtf8(COMMITS_CACHE_FILE), mCacheFileKey))
+      {
+         mCacheRestored = true;
+         mLastLogArgs = args;
+      }
+
+      const auto tips = maxCommits == 0 && args == mLastLogArgs ? incrementalTips(revisions) : QStringList();
+
+      mIncrementalLoad = !tips.isEmpty();
+      mLastLogArgs = args;
+
+      // The commit-graph has no author dates, so it can only give the history in the other orders.
+      if (maxCommits == 0 && !mIncrementalLoad && !mCacheRestored && order != QString("--author-date-order")
+          && loadFromCommitGraph(order, revisions))
+      {
+         notifyLoadingFinished();
+         return;
+      }
+
+      // The full history is loaded in two phases: a log without messages gives the topology, which is all the graph
+      // needs, and the author and message of the commits are read later only for the rows that are shown and the ones
+      // that follow them. The incremental loads bring few commits, so they take them complete from the log.
+      mTopologyOnly = !mIncrementalLoad;
+
+      if (mIncrementalLoad)
+      {
+         QLog_Debug("Git", QString("Loading the revisions not reachable from the {%1} loaded tips.").arg(tips.count()));
+
+         // The loaded tips would be listed as boundary commits, but they are already in the cache.
+         args.removeAll("--boundary");
+
+         for (const auto &tip : tips)
+            args.append(QString("^%1").arg(tip));
+      }
+      else
+      {
+         // The date is the author date, the one the complete log and the commit objects read later give.
+         args = QStringList { "log", order, "--no-show-signature", "--format=%at %H %P" };
+
+         if (maxCommits != 0)
+         {
+            // The limit is the size of the pages: the next ones are loaded when the view is scrolled to the end.
+            const auto pagedRevisions = mShowAll ? QString("--all") : mGitBase->getCurrentBranch();
+
+            mPageSize = maxCommits;
+            mPageArgs = args;
+            mPageRevisions = pagedRevisions.isEmpty() ? QString("HEAD") : pagedRevisions;
+
+            args.append(QString("--max-count=%1").arg(maxCommits));
+            args.append(mPageRevisions);
+         }
+         else
+            args.append(revisions.isEmpty() ? QString("HEAD") : revisions);
+      }
+
+      requestRevisionsStream(args);
+   }
+}
+
+QByteArray GitRepoLoader::cacheFileKey(const QString &order, const QString &revisions) const
+{
+   // The file is only valid for the references it was loaded from: if any of them moved, the history is loaded again.
+   const auto ret = mGitBase->run(QString("git rev-list --no-walk=unsorted %1").arg(revisions));
+
+   if (!ret.success)
+      return {};
+
+   QStringList tips;
+   const auto shas = ret.output.split('\n');
+
+   for (const auto &sha : shas)
+   {
+      if (const auto tip = sha.trimmed(); !tip.isEmpty())
+         tips.append(tip);
+   }
+
+   if (tips.isEmpty())
+      return {};
+
+   std::sort(tips.begin(), tips.end());
+   tips.prepend(order);
+
+   return tips.join('\n').toUtf8();
+}
+
+QStringList GitRepoLoader::incrementalTips(const QString &revisions) const
+{
+   if (!mRevCache->isInitialized() || revisions.isEmpty())
+      return {};
+
+   const auto tips = mRevCache->tips();
+
+   if (tips.isEmpty() || tips.count() > MAX_INCREMENTAL_TIPS)
+      return {};
+
+   // The incremental load can only add commits on top. If any loaded commit is not reachable anymore (reset, rebase,
+   // deleted branch...) the whole history has to be loaded again.
+   const auto ret = mGitBase->run(QString("git rev-list --count %1 --not %2").arg(tips.join(' '), revisions));
+
+   if (!ret.success || ret.output.trimmed().toInt() != 0)
+      return {};
 
-   mRevRequestor->run(baseCmd);
+   return tips;
+}
+
+bool GitRepoLoader::loadFromCommitGraph(const QString &order, const QString &revisions)
+{
+   CommitGraphReader graph(mGitBase->getGitDir());
+
+   if (!graph.open())
+      return false;
+
+   // Git doesn't use the commit-graph when there are replaced commits either: their parents are not the ones stored.
+   if (const auto ret = mGitBase->run("git for-each-ref --count=1 refs/replace/");
+       !ret.success || !ret.output.trimmed().isEmpty())
+   {
+      return false;
+   }
+
+   const auto ret = mGitBase->run(
+       QString("git rev-list --no-walk=unsorted %1").arg(revisions.isEmpty() ? QString("HEAD") : revisions));
+
+   if (!ret.success)
+      return false;
+
+   QVector<int> tips;
+   const auto shas = ret.output.split('\n');
+
+   for (const auto &sha : shas)
+   {
+      if (const auto tip = sha.trimmed(); !tip.isEmpty())
+      {
+         auto ok = false;
+         const auto oid = Oid::fromString(tip, &ok);
+         const auto position = ok ? graph.position(oid) : -1;
+
+         // The commits made after the commit-graph was written are not in it.
+         if (position == -1)
+         {
+            QLog_Debug("Git", "The commit-graph doesn't contain all the references, loading the log instead.");
+            return false;
+         }
+
+         tips.append(position);
+      }
+   }
+
+   if (tips.isEmpty())
+      return false;
+
+   auto ok = false;
+   auto commits = graph.log(tips,
+                            order == QString("--topo-order") ? CommitGraphReader::Order::Topological
+                                                             : CommitGraphReader::Order::Date,
+                            &ok);
+
+   if (!ok)
+   {
+      QLog_Warning("Git", "The commit-graph file is corrupted, loading the log instead.");
+      return false;
+   }
+
+   QLog_Info("Git", QString("Revisions read from the commit-graph: {%1}").arg(commits.count()));
+
+   auto pos = 0;
+   for (auto &commit : commits)
+      commit.pos = ++pos;
+
+   QScopedPointer<GitWip> git(new GitWip(mGitBase));
+   mRevCache->setUntrackedFilesList(git->getUntrackedFiles());
+
+   const auto info = git->getWipInfo().value();
+   mRevCache->setupTopology(info.first, info.second, std::move(commits));
+
+   return true;
+}
+
+void GitRepoLoader::requestMetadata()
+{
+   // Only one batch is read at a time. The requests that arrive meanwhile are read when it finishes.
+   if (mObjectReader->isBusy())
+      return;
+
+   auto shas = mRevCache->takeMetadataRequests();
+
+   // The rows shown always go first. Between them, and once the load finished, the rows after them are prefetched, and
+   // the rest of the history only if the search asked for it.
+   mBackgroundMetadata = shas.isEmpty() && !mLocked;
+
+   if (mBackgroundMetadata)
+      shas = mRevCache->takeBackgroundMetadataRequests(BACKGROUND_METADATA_BATCH);
+
+   mObjectReader->read(mGitBase->getWorkingDir(), shas);
+
+   // The file is rewritten when the reader goes idle, so the commits read until then are restored with their metadata.
+   if (mCacheOutdated && !mObjectReader->isBusy() && !mCacheSaveTimer->isActive())
+      mCacheSaveTimer->start();
+}
+
+void GitRepoLoader::processMetadata(QVector<CommitInfo> commits)
+{
+   const auto background = mBackgroundMetadata;
+
+   if (!commits.isEmpty())
+   {
+      mRevCache->updateMetadata(commits);
+      mCacheOutdated = mCacheSavable;
+   }
+
+   requestMetadata();
+
+   // The rows shown are waiting for their batch. The background batches are published together every few moments,
+   // or as soon as there is nothing else to read.
+   if (!background || !mObjectReader->isBusy())
+      publishMetadata();
+   else if (!mMetadataTimer->isActive())
+      mMetadataTimer->start();
+}
+
+void GitRepoLoader::publishMetadata()
+{
+   mMetadataTimer->stop();
+
+   auto firstRow = -1;
+   auto lastRow = -1;
+
+   if (mRevCache->publishMetadata(&firstRow, &lastRow))
+      emit signalMetadataLoaded(firstRow, lastRow);
+}
+
+void GitRepoLoader::saveCommitsCache()
+{
+   // Another load or batch started meanwhile: the file is saved when the reader goes idle again.
+   if (!mCacheOutdated || mLocked || mObjectReader->isBusy())
+      return;
+
+   const auto fileName = mGitBase->getGitDir() + QString::fromUtf8(COMMITS_CACHE_FILE);
+
+   mCacheOutdated = false;
+
+   if (!mRevCache->saveCommits(fileName, mCacheFileKey))
+      QLog_Warning("Git", QString("The history couldn't be saved in {%1}.").arg(fileName));
+}
+
+void GitRepoLoader::requestRevisionsStream(const QStringList &args, const QStringList &stdinRevisions)
+{
+   mLogBuffer.clear();
+   mPendingCommits.clear();
+   mParsedCommits = 0;
+   mBatchSize = FIRST_LOG_BATCH;
+   mStreamToCache = !mIncrementalLoad && (!mRevCache->isInitialized() || mCacheRestored);
+   mCacheStarted = false;
+
+   mLogProcess = new QProcess(this);
+   mLogProcess->setWorkingDirectory(mGitBase->getWorkingDir());
+
+   connect(mLogProcess, &QProcess::readyReadStandardOutput, this, &GitRepoLoader::processRevisionsChunk);
+   connect(mLogProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+           &GitRepoLoader::processRevisionsStreamEnd);
+   connect(mLogProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+      if (error == QProcess::FailedToStart)
+      {
+         QLog_Error("Git",
+                    QString("Git couldn't be started to load the revisions: %1").arg(mLogProcess->errorString()));
+
+         mLogProcess->deleteLater();
+         mLogProcess = nullptr;
+
+         if (std::exchange(mPageLoad, false))
+         {
+            mMoreRevisions = false;
+            mLocked = false;
+
+            emit signalMoreRevisionsAvailable(false);
+         }
+         else
+            notifyLoadingFinished();
+      }
+   });
+   connect(this, &GitRepoLoader::cancelAllProcesses, mLogProcess, &QProcess::kill);
+
+   mLogProcess->start("git", args);
+
+   // A process that failed to start has already been released by the error handler.
+   if (!mLogProcess)
+      return;
+
+   if (!stdinRevisions.isEmpty())
+   {
+      mLogProcess->write(stdinRevisions.join("\n").toLatin1());
+      mLogProcess->write("\n");
+   }
+
+   mLogProcess->closeWriteChannel();
+}
+
+void GitRepoLoader::processRevisionsChunk()
+{
+   mLogBuffer.append(mLogProcess->readAllStandardOutput());
+
+   parseRevisionsBuffer(false);
+
+   if (mPendingCommits.count() >= mBatchSize)
+      publishPendingCommits();
+}
+
+void GitRepoLoader::processRevisionsStreamEnd(int exitCode, QProcess::ExitStatus exitStatus)
+{
+   if (exitStatus == QProcess::NormalExit)
+   {
+      mLogBuffer.append(mLogProcess->readAllStandardOutput());
+      parseRevisionsBuffer(true);
+      mLogBuffer.clear();
+
+      if (exitCode != 0)
+      {
+         QLog_Warning("Git",
+                      QString("Git log finished with errors: %1")
+                          .arg(QString::fromUtf8(mLogProcess->readAllStandardError())));
+      }
+
+      QLog_Info("Git", QString("Revisions received: {%1}").arg(mParsedCommits));
+
+      if (exitCode != 0)
+         mLastLogArgs.clear();
+
+      if (mPageLoad)
+      {
+         // The boundary doesn't reach the loaded commits, but they are skipped anyway so a page never repeats a row.
+         const auto commits = mRevCache->snapshot();
+         mPendingCommits.erase(std::remove_if(mPendingCommits.begin(), mPendingCommits.end(),
+                                              [&commits](const CommitInfo &commit) {
+                                                 return commits->row(commit.sha) != -1;
+                                              }),
+                               mPendingCommits.end());
+
+         if (exitCode == 0 && !mPendingCommits.isEmpty())
+         {
+            mRevCache->appendCommits(std::move(mPendingCommits), true);
+            mRevCache->endSetup();
+         }
+      }
+      else if (mStreamToCache)
+      {
+         publishPendingCommits();
+
+         if (mCacheStarted)
+            mRevCache->endSetup();
+      }
+      else if (mIncrementalLoad)
+      {
+         if (exitCode == 0)
+         {
+            QScopedPointer<GitWip> git(new GitWip(mGitBase));
+            mRevCache->setUntrackedFilesList(git->getUntrackedFiles());
+
+            const auto info = git->getWipInfo().value();
+            mRevCache->prependCommits(info.first, info.second, std::move(mPendingCommits));
+
+            // A restored cache hasn't been shown yet, so the view is loaded from scratch when the loading finishes.
+            if (!mCacheRestored)
+               emit signalRevisionsInserted(1, mParsedCommits);
+         }
+      }
+      else if (mParsedCommits > 0)
+      {
+         QScopedPointer<GitWip> git(new GitWip(mGitBase));
+         mRevCache->setUntrackedFilesList(git->getUntrackedFiles());
+
+         const auto info = git->getWipInfo().value();
+
+         if (mTopologyOnly)
+            mRevCache->setupTopology(info.first, info.second, std::move(mPendingCommits));
+         else
+            mRevCache->setup(info.first, info.second, std::move(mPendingCommits));
+      }
+   }
+   else
+   {
+      mLastLogArgs.clear();
+
+      QLog_Warning("Git", "The loading of the revisions was cancelled.");
+   }
+
+   mLogBuffer.clear();
+   mLogBuffer.squeeze();
+   mPendingCommits.clear();
+   mPendingCommits.squeeze();
+
+   mLogProcess->deleteLater();
+   mLogProcess = nullptr;
+
+   const auto loaded = exitStatus == QProcess::NormalExit && exitCode == 0;
+   mCacheRestored = false;
+
+   // The file is written once the metadata of the rows shown has been read as well, so they aren't restored pending.
+   if (loaded && mParsedCommits > 0 && !mCacheFileKey.isEmpty() && !mPageLoad)
+      mCacheSavable = mCacheOutdated = true;
+
+   if (mPageSize > 0)
+   {
+      // A full page means that there can be more commits after it.
+      mPagedCommits += loaded ? mParsedCommits : 0;
+      mMoreRevisions = loaded && mParsedCommits == mPageSize;
+   }
+
+   if (std::exchange(mPageLoad, false))
+   {
+      mLocked = false;
+
+      emit signalRevisionsPageLoaded(mRevCache->commitCount(), mMoreRevisions);
+      return;
+   }
+
+   if (mPageSize > 0)
+      emit signalMoreRevisionsAvailable(mMoreRevisions);
+
+   notifyLoadingFinished();
+}
+
+void GitRepoLoader::parseRevisionsBuffer(bool includeTail)
+{
+   qsizetype consumed = 0;
+
+   appendParsedCommits(mTopologyOnly ? parseRevListLines(mLogBuffer, includeTail, &consumed)
+                                     : parseLogRecords(mLogBuffer, includeTail, &consumed));
+
+   mLogBuffer.remove(0, consumed);
+}
+
+void GitRepoLoader::appendParsedCommits(QVector<CommitInfo> commits)
+{
+   mPendingCommits.reserve(mPendingCommits.count() + commits.count());
+
+   for (auto &commit : commits)
+   {
+      commit.pos = ++mParsedCommits;
+      mPendingCommits.append(std::move(commit));
+   }
+}
+
+void GitRepoLoader::publishPendingCommits()
+{
+   if (!mStreamToCache || mPendingCommits.isEmpty())
+      return;
+
+   if (!mCacheStarted)
+   {
+      QScopedPointer<GitWip> git(new GitWip(mGitBase));
+      mRevCache->setUntrackedFilesList(git->getUntrackedFiles());
+
+      const auto info = git->getWipInfo().value();
+      mRevCache->beginSetup(info.first, info.second);
+
+      mCacheStarted = true;
+   }
+
+   mRevCache->appendCommits(std::move(mPendingCommits), mTopologyOnly);
+   mPendingCommits.clear();
+
+   mBatchSize = std::min(mBatchSize * 2, MAX_LOG_BATCH);
+
+   emit signalRevisionsAppended(mRevCache->commitCount());
 }
 
 void GitRepoLoader::processRevisions(QByteArray ba)
@@ -279,20 +1020,11 @@ void GitRepoLoader::processRevisions(QByteArray ba)
 
 QVector<CommitInfo> GitRepoLoader::processUnsignedLog(QByteArray &log) const
 {
-   auto lines = log.split('\000');
-   QVector<CommitInfo> commits;
-   commits.reserve(lines.count());
+   auto commits = parseLogRecords(log, true);
 
    auto pos = 0;
-   while (!lines.isEmpty())
-   {
-      std::string lineStr = lines.takeFirst().toStdString();
-      if (auto commit = CommitInfo { lineStr.c_str() }; commit.isValid())
-      {
-         commit.pos = ++pos;
-         commits.append(std::move(commit));
-      }
-   }
+   for (auto &commit : commits)
+      commit.pos = ++pos;
 
    return commits;
 }
@@ -375,5 +1107,7 @@ void GitRepoLoader::notifyLoadingFinished()
 
       mLocked = false;
       mRefreshReferences = false;
+
+      requestMetadata();
    }
 }
@@ -25,8 +25,10 @@
 
 #include <CommitInfo.h>
 #include <GitExecResult.h>
+#include <ReferencesReader.h>
 
 #include <QObject>
+#include <QProcess>
 #include <QSharedPointer>
 #include <QVector>
 
@@ -36,6 +38,8 @@ class GitCache;
 class GitQlientSettings;
 class GitTags;
 class GitRequestorProcess;
+class CommitObjectReader;
+class QTimer;
 
 class GitRepoLoader : public QObject
 {
@@ -44,12 +48,18 @@ class GitRepoLoader : public QObject
 signals:
    void signalLoadingStarted();
    void signalLoadingFinished(bool full);
+   void signalRevisionsAppended(int totalCommits);
+   void signalRevisionsInserted(int firstRow, int count);
+   void signalMetadataLoaded(int firstRow, int lastRow);
+   void signalRevisionsPageLoaded(int totalCommits, bool moreRevisions);
+   void signalMoreRevisionsAvailable(bool moreRevisions);
    void cancelAllProcesses(QPrivateSignal);
 
 public slots:
    void loadLogHistory();
    void loadReferences();
    void loadAll();
+   void loadMoreRevisions();
 
 public:
    explicit GitRepoLoader(QSharedPointer<GitBase> gitBase, QSharedPointer<GitCache> cache,
@@ -68,12 +78,50 @@ private:
    QSharedPointer<GitTags> mGitTags;
    GitRequestorProcess *mRevRequestor = nullptr;
    GitRequestorProcess *mRefRequestor = nullptr;
+   CommitObjectReader *mObjectReader = nullptr;
+   QTimer *mMetadataTimer = nullptr;
+   QTimer *mCacheSaveTimer = nullptr;
+   bool mBackgroundMetadata = false;
+   QProcess *mLogProcess = nullptr;
+   QByteArray mLogBuffer;
+   QVector<CommitInfo> mPendingCommits;
+   int mParsedCommits = 0;
+   int mBatchSize = 0;
+   bool mStreamToCache = false;
+   bool mCacheStarted = false;
+   bool mIncrementalLoad = false;
+   bool mTopologyOnly = false;
+   bool mPageLoad = false;
+   bool mMoreRevisions = false;
+   int mPageSize = 0;
+   int mPagedCommits = 0;
+   QStringList mPageArgs;
+   QString mPageRevisions;
+   QStringList mLastLogArgs;
+   QByteArray mCacheFileKey;
+   bool mCacheRestored = false;
+   bool mCacheSavable = false;
+   bool mCacheOutdated = false;
 
    bool configureRepoDirectory();
    void requestReferences();
    void processReferences(QByteArray ba);
+   void updateReferences(const QVector<ReferencesReader::Reference> &references, const QString &headSha);
    void requestRevisions();
    void processRevisions(QByteArray ba);
+   QByteArray cacheFileKey(const QString &order, const QString &revisions) const;
+   QStringList incrementalTips(const QString &revisions) const;
+   bool loadFromCommitGraph(const QString &order, const QString &revisions);
+   void requestMetadata();
+   void processMetadata(QVector<CommitInfo> commits);
+   void publishMetadata();
+   void saveCommitsCache();
+   void requestRevisionsStream(const QStringList &args, const QStringList &stdinRevisions = {});
+   void processRevisionsChunk();
+   void processRevisionsStreamEnd(int exitCode, QProcess::ExitStatus exitStatus);
+   void parseRevisionsBuffer(bool includeTail);
+   void appendParsedCommits(QVector<CommitInfo> commits);
+   void publishPendingCommits();
    QVector<CommitInfo> processUnsignedLog(QByteArray &log) const;
    QVector<CommitInfo> processSignedLog(QByteArray &log) const;
    void notifyLoadingFinished();
@@ -0,0 +1,203 @@
+#include "LaneLayout.h"
+
+#include <CommitTable.h>
+
+#include <algorithm>
+
+namespace
+{
+const int CHECKPOINT_ROWS = 512;
+const int MAX_BLOCKS = 64;
+const int PREFETCH_ROWS = 128;
+
+/**
+ * @brief Moves the lanes to the next row. The lanes of the row are appended to @p types when it's set.
+ *
+ * @return The index of the active lane of the row, or -1 if the lanes were not stored.
+ */
+int calculateLanes(Lanes &lanes, int id, const QVector<int> &parents, QByteArray *types = nullptr)
+{
+   bool isDiscontinuity;
+   const auto isFork = lanes.isFork(id, isDiscontinuity);
+   const auto isMerge = parents.count() > 1;
+
+   if (isDiscontinuity)
+      lanes.changeActiveLane(id);
+
+   if (isFork)
+      lanes.setFork(id);
+   if (isMerge)
+      lanes.setMerge(parents);
+   if (parents.isEmpty())
+      lanes.setInitial();
+
+   auto activeLane = -1;
+
+   if (types)
+   {
+      const auto &rowLanes = lanes.getLanes();
+
+      for (auto i = 0; i < rowLanes.count(); ++i)
+      {
+         if (activeLane == -1 && rowLanes.at(i).isActive())
+            activeLane = i;
+
+         types->append(static_cast<char>(rowLanes.at(i).getType()));
+      }
+   }
+
+   lanes.nextParent(parents.isEmpty() ? Lanes::NO_COMMIT : parents.constFirst());
+
+   if (isMerge)
+      lanes.afterMerge();
+   if (isFork)
+      lanes.afterFork();
+   if (lanes.isBranch())
+      lanes.afterBranch();
+
+   return activeLane;
+}
+}
+
+LaneRow LaneLayout::row(const CommitTable &commits, int row)
+{
+   if (row < 0 || row >= commits.count())
+      return LaneRow();
+
+   QMutexLocker lock(&mMutex);
+
+   const auto index = row / CHECKPOINT_ROWS;
+   const auto offset = row % CHECKPOINT_ROWS;
+   const auto &rowBlock = block(commits, index);
+   const auto start = rowBlock.offsets.at(offset);
+   const LaneRow lanes(rowBlock.lanes, start, rowBlock.offsets.at(offset + 1) - start,
+                       rowBlock.activeLanes.at(offset));
+
+   // The rows next to the one read are the next ones to be painted when scrolling.
+   if (offset >= CHECKPOINT_ROWS - PREFETCH_ROWS && (index + 1) * CHECKPOINT_ROWS < commits.count())
+      block(commits, index + 1);
+   else if (offset < PREFETCH_ROWS && index > 0)
+      block(commits, index - 1);
+
+   return lanes;
+}
+
+std::shared_ptr<LaneLayout> LaneLayout::renamed(const QHash<int, int> &ids)
+{
+   auto layout = std::make_shared<LaneLayout>();
+
+   QMutexLocker lock(&mMutex);
+
+   layout->mCheckpoints = mCheckpoints;
+   layout->mBlocks = mBlocks;
+   layout->mUses = mUses;
+
+   for (auto &checkpoint : layout->mCheckpoints)
+      checkpoint.renameIds(ids);
+
+   return layout;
+}
+
+std::shared_ptr<LaneLayout> LaneLayout::invalidated(int row, int count)
+{
+   auto layout = std::make_shared<LaneLayout>();
+   const auto firstChanged = std::max(row, 0) / CHECKPOINT_ROWS;
+
+   QMutexLocker lock(&mMutex);
+
+   // The checkpoint of the block of the row is the state before its first row, which is still above the change.
+   layout->mCheckpoints = mCheckpoints.mid(0, firstChanged + 1);
+   layout->mUses = mUses;
+
+   for (auto iter = mBlocks.cbegin(); iter != mBlocks.cend(); ++iter)
+   {
+      if (iter.key() < firstChanged)
+         layout->mBlocks.insert(iter.key(), iter.value());
+   }
+
+   if (count > 0)
+   {
+      for (auto &checkpoint : layout->mCheckpoints)
+         checkpoint.shiftIds(row, count);
+   }
+
+   return layout;
+}
+
+const LaneLayout::Block &LaneLayout::block(const CommitTable &commits, int index)
+{
+   const auto first = index * CHECKPOINT_ROWS;
+   const auto rows = std::min(CHECKPOINT_ROWS, commits.count() - first);
+
+   // A block calculated when the table had less rows is calculated again.
+   if (const auto iter = mBlocks.find(index); iter != mBlocks.end() && iter->rows >= rows)
+   {
+      iter->lastUse = ++mUses;
+      return *iter;
+   }
+
+   if (mCheckpoints.isEmpty())
+   {
+      Lanes lanes;
+      lanes.init(0);
+      mCheckpoints.append(lanes);
+   }
+
+   QVector<int> parents;
+
+   auto current = std::min(index, static_cast<int>(mCheckpoints.count()) - 1);
+   auto lanes = mCheckpoints.at(current);
+
+   for (; current < index; ++current)
+   {
+      const auto end = (current + 1) * CHECKPOINT_ROWS;
+
+      for (auto row = current * CHECKPOINT_ROWS; row < end; ++row)
+      {
+         parentIds(commits, row, parents);
+         calculateLanes(lanes, row, parents);
+      }
+
+      mCheckpoints.append(lanes);
+   }
+
+   Block block;
+   block.rows = rows;
+   block.offsets.reserve(rows + 1);
+   block.offsets.append(0);
+   block.activeLanes.reserve(rows);
+
+   for (auto row = first; row < first + rows; ++row)
+   {
+      parentIds(commits, row, parents);
+
+      block.activeLanes.append(calculateLanes(lanes, row, parents, &block.lanes));
+      block.offsets.append(static_cast<int>(block.lanes.size()));
+   }
+
+   if (rows == CHECKPOINT_ROWS && mCheckpoints.count() == index + 1)
+      mCheckpoints.append(lanes);
+
+   if (mBlocks.count() >= MAX_BLOCKS && !mBlocks.contains(index))
+   {
+      const auto oldest = std::min_element(mBlocks.cbegin(), mBlocks.cend(), [](const Block &a, const Block &b) {
+         return a.lastUse < b.lastUse;
+      });
+
+      mBlocks.remove(oldest.key());
+   }
+
+   block.lastUse = ++mUses;
+
+   return *mBlocks.insert(index, std::move(block));
+}
+
+void LaneLayout::parentIds(const CommitTable &commits, int row, QVector<int> &parents) const
+{
+   const auto count = commits.parentsCount(row);
+
+   parents.resize(count);
+
+   for (auto i = 0; i < count; ++i)
+      parents[i] = laneId(commits.parentId(row, i));
+}
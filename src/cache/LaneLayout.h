@@ -0,0 +1,135 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <Lane.h>
+#include <LaneType.h>
+#include <lanes.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+#include <memory>
+
+class CommitTable;
+
+/**
+ * @brief The LaneRow class is a view over the lanes of one row of the graph: one LaneType byte per lane in the block
+ * where the row was calculated. It shares that block, so it's still valid after the layout drops it.
+ */
+class LaneRow
+{
+public:
+   LaneRow() = default;
+   LaneRow(const QByteArray &lanes, int start, int count, int activeLane)
+      : mLanes(lanes)
+      , mData(mLanes.constData() + start)
+      , mCount(count)
+      , mActiveLane(activeLane)
+   {
+   }
+
+   int count() const { return mCount; }
+   Lane at(int index) const { return Lane(static_cast<LaneType>(static_cast<uchar>(mData[index]))); }
+   int activeLane() const { return mActiveLane; }
+
+private:
+   QByteArray mLanes;
+   const char *mData = nullptr;
+   int mCount = 0;
+   int mActiveLane = -1;
+};
+
+/**
+ * @brief The LaneLayout class calculates the lanes of the commit graph on demand. The lanes of a row depend on all the
+ * rows above it, so the state of the lanes is saved every few hundred rows as a checkpoint and the lanes of any row
+ * are calculated by replaying the rows from the closest checkpoint above it. Only the blocks of lanes around the rows
+ * read last are kept in memory.
+ *
+ * The lanes identify the commits by their row, or by a negative id for the parents that are not in the table.
+ *
+ * A layout belongs to the rows of one CommitTable: appending rows to the table keeps it valid, but inserting rows or
+ * changing the parents of a row requires a new layout from that row on, given by invalidated(). When a parent that was
+ * missing arrives, only its id changes, so the layout can be carried over with renamed() instead. The class is
+ * thread-safe.
+ */
+class LaneLayout
+{
+public:
+   /**
+    * @brief Returns the lanes of a row, calculating them if they are not in memory.
+    *
+    * @param commits The table that the layout belongs to.
+    * @param row The row of the commit.
+    * @return The lanes of the row or an empty row if it's out of range.
+    */
+   LaneRow row(const CommitTable &commits, int row);
+
+   /**
+    * @brief Creates a copy of the layout where the lanes that expected the commits of @p ids expect their new ids. The
+    * lanes already calculated don't depend on the ids, so they are kept.
+    *
+    * @param ids The new id of every commit whose id changed.
+    * @return The new layout.
+    */
+   std::shared_ptr<LaneLayout> renamed(const QHash<int, int> &ids);
+
+   /**
+    * @brief Creates a copy of the layout for the table where @p count rows were inserted, or changed when it's 0, at
+    * @p row. The checkpoints and blocks above the row don't depend on the rows below it, so they are kept with the ids
+    * of the rows that moved updated. The rest is calculated again when it's read.
+    *
+    * @param row The first row inserted or changed.
+    * @param count The number of rows inserted.
+    * @return The new layout.
+    */
+   std::shared_ptr<LaneLayout> invalidated(int row, int count);
+
+   /**
+    * @brief Returns the id that the lanes use for a parent reference of the CommitTable. The negative references of the
+    * parents outside of the table are moved below Lanes::NO_COMMIT.
+    */
+   static int laneId(int reference) { return reference >= 0 ? reference : reference - 1; }
+
+private:
+   struct Block
+   {
+      int rows = 0;
+      QVector<int> offsets;
+      QByteArray lanes;
+      QVector<int> activeLanes;
+      quint64 lastUse = 0;
+   };
+
+   QMutex mMutex;
+   QVector<Lanes> mCheckpoints; // The state of the lanes before the first row of every block.
+   QHash<int, Block> mBlocks;
+   quint64 mUses = 0;
+
+   const Block &block(const CommitTable &commits, int index);
+   void parentIds(const CommitTable &commits, int row, QVector<int> &parents) const;
+};
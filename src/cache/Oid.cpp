@@ -0,0 +1,88 @@
+#include "Oid.h"
+
+#include <algorithm>
+
+namespace
+{
+int hexValue(QChar character)
+{
+   const auto value = character.unicode();
+
+   if (value >= '0' && value <= '9')
+      return value - '0';
+   if (value >= 'a' && value <= 'f')
+      return value - 'a' + 10;
+   if (value >= 'A' && value <= 'F')
+      return value - 'A' + 10;
+
+   return -1;
+}
+}
+
+Oid Oid::fromString(const QString &sha, bool *ok)
+{
+   Oid oid;
+   auto valid = sha.size() == static_cast<qsizetype>(oid.bytes.size() * 2);
+
+   for (auto i = 0U; valid && i < oid.bytes.size(); ++i)
+   {
+      const auto high = hexValue(sha.at(2 * i));
+      const auto low = hexValue(sha.at(2 * i + 1));
+
+      valid = high >= 0 && low >= 0;
+      oid.bytes[i] = static_cast<uchar>(high << 4 | low);
+   }
+
+   if (ok)
+      *ok = valid;
+
+   return valid ? oid : Oid();
+}
+
+QString Oid::toString() const
+{
+   static const char digits[] = "0123456789abcdef";
+
+   QString sha(static_cast<qsizetype>(bytes.size() * 2), Qt::Uninitialized);
+   auto data = sha.data();
+
+   for (const auto byte : bytes)
+   {
+      *data++ = QLatin1Char(digits[byte >> 4]);
+      *data++ = QLatin1Char(digits[byte & 0xF]);
+   }
+
+   return sha;
+}
+
+bool OidPrefix::matches(const Oid &oid) const
+{
+   const auto fullBytes = static_cast<size_t>(length / 2);
+
+   if (!std::equal(lowerBound.bytes.cbegin(), lowerBound.bytes.cbegin() + fullBytes, oid.bytes.cbegin()))
+      return false;
+
+   return length % 2 == 0 || (oid.bytes[fullBytes] & 0xF0) == lowerBound.bytes[fullBytes];
+}
+
+OidPrefix OidPrefix::fromString(const QString &shaPrefix, bool *ok)
+{
+   OidPrefix prefix;
+   auto valid = !shaPrefix.isEmpty() && shaPrefix.size() <= static_cast<qsizetype>(prefix.lowerBound.bytes.size() * 2);
+
+   for (auto i = 0; valid && i < shaPrefix.size(); ++i)
+   {
+      const auto value = hexValue(shaPrefix.at(i));
+
+      valid = value >= 0;
+      prefix.lowerBound.bytes[i / 2] |= static_cast<uchar>(i % 2 == 0 ? value << 4 : value);
+   }
+
+   if (valid)
+      prefix.length = static_cast<int>(shaPrefix.size());
+
+   if (ok)
+      *ok = valid;
+
+   return valid ? prefix : OidPrefix();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2022  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+#include <QHash>
+#include <QString>
+
+#include <array>
+
+/**
+ * @brief Binary form of a Git object id. It takes 20 bytes instead of the 80 bytes plus header of the hexadecimal
+ * QString.
+ */
+struct Oid
+{
+   std::array<uchar, 20> bytes {};
+
+   bool operator==(const Oid &other) const { return bytes == other.bytes; }
+   bool operator!=(const Oid &other) const { return bytes != other.bytes; }
+   bool operator<(const Oid &other) const { return bytes < other.bytes; }
+
+   static Oid fromString(const QString &sha, bool *ok = nullptr);
+   QString toString() const;
+};
+
+/**
+ * @brief Abbreviated SHA parsed to binary. It can be compared against an Oid without converting the Oid to text, and its
+ * lower bound can be used to look it up in a sorted list of ids.
+ */
+struct OidPrefix
+{
+   Oid lowerBound;
+   int length = 0;
+
+   bool matches(const Oid &oid) const;
+
+   static OidPrefix fromString(const QString &shaPrefix, bool *ok = nullptr);
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+inline size_t qHash(const Oid &oid, size_t seed = 0)
+#else
+inline uint qHash(const Oid &oid, uint seed = 0)
+#endif
+{
+   return qHashBits(oid.bytes.data(), oid.bytes.size(), seed);
+}
@@ -0,0 +1,163 @@
+#include "ReferenceIndex.h"
+
+#include <CommitTable.h>
+
+#include <algorithm>
+
+void ReferenceIndex::clear()
+{
+   mNames.clear();
+   mNames.squeeze();
+   mNameIds.clear();
+   mNameIds.squeeze();
+   mReferences.clear();
+   mReferences.squeeze();
+
+   for (auto &oids : mOidsByName)
+   {
+      oids.clear();
+      oids.squeeze();
+   }
+
+   mRowsWithReferences.fill(false);
+}
+
+bool ReferenceIndex::insert(const Oid &oid, References::Type type, const QString &name)
+{
+   const auto id = nameId(name);
+   auto &oids = mOidsByName[static_cast<int>(type)];
+
+   if (const auto current = oids.constFind(id); current != oids.cend())
+   {
+      const auto previous = current.value();
+
+      if (previous == oid)
+         return false;
+
+      // A name points to a single commit: the reference moves.
+      remove(previous, type, name);
+   }
+
+   mReferences[oid].append({ id, type });
+   oids.insert(id, oid);
+
+   setRow(oid, true);
+
+   return true;
+}
+
+bool ReferenceIndex::remove(const Oid &oid, References::Type type, const QString &name)
+{
+   const auto id = mNameIds.value(name, -1);
+   const auto references = mReferences.find(oid);
+
+   if (id == -1 || references == mReferences.end())
+      return false;
+
+   const auto reference = std::find_if(references->begin(), references->end(), [id, type](const Reference &ref) {
+      return ref.name == id && ref.type == type;
+   });
+
+   if (reference == references->end())
+      return false;
+
+   references->erase(reference);
+   mOidsByName[static_cast<int>(type)].remove(id);
+
+   if (references->isEmpty())
+   {
+      mReferences.erase(references);
+      setRow(oid, false);
+   }
+
+   return true;
+}
+
+bool ReferenceIndex::hasReferences(int row) const
+{
+   return row >= 0 && row < mRowsWithReferences.size() && mRowsWithReferences.testBit(row);
+}
+
+QStringList ReferenceIndex::references(const Oid &oid, References::Type type) const
+{
+   QStringList names;
+
+   if (const auto references = mReferences.constFind(oid); references != mReferences.cend())
+   {
+      for (const auto &reference : *references)
+      {
+         if (reference.type == type)
+            names.append(mNames.at(reference.name));
+      }
+   }
+
+   return names;
+}
+
+QVector<QPair<Oid, QStringList>> ReferenceIndex::references(References::Type type) const
+{
+   QVector<QPair<Oid, QStringList>> references;
+   references.reserve(mReferences.count());
+
+   for (auto iter = mReferences.cbegin(); iter != mReferences.cend(); ++iter)
+      references.append(qMakePair(iter.key(), this->references(iter.key(), type)));
+
+   return references;
+}
+
+std::optional<Oid> ReferenceIndex::oid(const QString &name, References::Type type) const
+{
+   const auto id = mNameIds.value(name, -1);
+
+   if (id == -1)
+      return std::nullopt;
+
+   const auto &oids = mOidsByName[static_cast<int>(type)];
+
+   if (const auto oid = oids.constFind(id); oid != oids.cend())
+      return oid.value();
+
+   return std::nullopt;
+}
+
+void ReferenceIndex::indexRows(std::shared_ptr<const CommitTable> commits, int firstRow)
+{
+   const auto rows = commits->count();
+   const auto indexedRows = mCommits ? static_cast<int>(mRowsWithReferences.size()) : 0;
+   const auto keptRows = std::clamp(firstRow, 0, std::min(rows, indexedRows));
+
+   mCommits = std::move(commits);
+
+   // Publishing the metadata doesn't move any row, so the bits stay as they are.
+   if (keptRows == rows && mRowsWithReferences.size() == rows)
+      return;
+
+   mRowsWithReferences.resize(rows);
+   mRowsWithReferences.fill(false, keptRows, rows);
+
+   for (auto iter = mReferences.cbegin(); iter != mReferences.cend(); ++iter)
+   {
+      if (const auto row = mCommits->row(iter.key()); row >= keptRows)
+         mRowsWithReferences.setBit(row);
+   }
+}
+
+int ReferenceIndex::nameId(const QString &name)
+{
+   auto id = mNameIds.value(name, -1);
+
+   if (id == -1)
+   {
+      id = mNames.count();
+      mNames.append(name);
+      mNameIds.insert(name, id);
+   }
+
+   return id;
+}
+
+void ReferenceIndex::setRow(const Oid &oid, bool hasReferences)
+{
+   if (const auto row = mCommits ? mCommits->row(oid) : -1; row >= 0 && row < mRowsWithReferences.size())
+      mRowsWithReferences.setBit(row, hasReferences);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <Oid.h>
+#include <References.h>
+
+#include <QBitArray>
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+#include <array>
+#include <memory>
+#include <optional>
+
+class CommitTable;
+
+/**
+ * @brief The ReferenceIndex class stores the references (branches and tags) of the repository. The names are interned
+ * once and referred by id: every commit keeps the ids of its references and every type of reference has a reverse
+ * hash from the name to the commit, so both directions are a single lookup.
+ *
+ * The index also keeps a bit per row of the commit table that tells if the commit has any reference. It's updated
+ * with every change of the references and with @ref indexRows when a new version of the table is published.
+ */
+class ReferenceIndex
+{
+public:
+   void clear();
+
+   bool insert(const Oid &oid, References::Type type, const QString &name);
+   bool remove(const Oid &oid, References::Type type, const QString &name);
+
+   bool hasReferences(const Oid &oid) const { return mReferences.contains(oid); }
+   bool hasReferences(int row) const;
+   QStringList references(const Oid &oid, References::Type type) const;
+   QVector<QPair<Oid, QStringList>> references(References::Type type) const;
+   std::optional<Oid> oid(const QString &name, References::Type type) const;
+
+   /**
+    * @brief Updates the bits of the rows that have references to a new version of the commit table. Only the rows from
+    * @p firstRow are indexed again: the ones before it keep the commit they had in the previous version.
+    *
+    * @param commits The commit table whose rows are indexed.
+    * @param firstRow The first row that changed, or the count of the table if only the metadata changed.
+    */
+   void indexRows(std::shared_ptr<const CommitTable> commits, int firstRow);
+   /**
+    * @brief Returns the bits of the rows that have references. The copy is shared until the index changes.
+    */
+   QBitArray rowsWithReferences() const { return mRowsWithReferences; }
+
+private:
+   static const int TYPES = 4;
+
+   struct Reference
+   {
+      int name = -1;
+      References::Type type = References::Type::LocalTag;
+   };
+
+   QVector<QString> mNames;
+   QHash<QString, int> mNameIds;
+   QHash<Oid, QVector<Reference>> mReferences;
+   std::array<QHash<int, Oid>, TYPES> mOidsByName;
+   std::shared_ptr<const CommitTable> mCommits;
+   QBitArray mRowsWithReferences;
+
+   int nameId(const QString &name);
+   void setRow(const Oid &oid, bool hasReferences);
+};
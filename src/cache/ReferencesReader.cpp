@@ -0,0 +1,197 @@
+#include "ReferencesReader.h"
+
+#include <CommitTable.h>
+#include <Oid.h>
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+namespace
+{
+bool isSha(const QString &value)
+{
+   auto ok = false;
+   Oid::fromString(value, &ok);
+
+   return ok;
+}
+
+QString readRefFile(const QString &fileName)
+{
+   QFile file(fileName);
+
+   return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()).trimmed() : QString();
+}
+}
+
+ReferencesReader::ReferencesReader(const QString &gitDir)
+   : mGitDir(gitDir)
+   , mCommonDir(gitDir)
+{
+   // The worktrees keep their HEAD in their own directory but share the references of the main repository.
+   if (const auto commonDir = readRefFile(QString("%1/commondir").arg(mGitDir)); !commonDir.isEmpty())
+      mCommonDir = QDir(mGitDir).absoluteFilePath(commonDir);
+}
+
+bool ReferencesReader::read(const CommitTable &commits)
+{
+   mReferences.clear();
+   mHeadSha.clear();
+
+   if (mGitDir.isEmpty() || QFileInfo::exists(QString("%1/reftable").arg(mCommonDir)))
+      return false;
+
+   QHash<QString, QString> refs;
+   QHash<QString, QString> peeled;
+   auto peeledTags = false;
+
+   if (!readPackedRefs(refs, peeled, peeledTags))
+      return false;
+
+   // The loose references are newer than the packed ones. Their tags are never peeled.
+   const auto packedRefs = refs;
+
+   if (!readLooseRefs(refs, peeled))
+      return false;
+
+   mReferences.reserve(refs.count());
+
+   for (auto iter = refs.cbegin(); iter != refs.cend(); ++iter)
+   {
+      const auto &refName = iter.key();
+
+      if (refName.startsWith("refs/tags/"))
+      {
+         // Only the annotated tags are shown, on the commit they point to.
+         if (const auto peeledSha = peeled.constFind(refName); peeledSha != peeled.cend())
+            mReferences.append({ peeledSha.value(), References::Type::LocalTag, refName.mid(10) });
+         else if (commits.row(iter.value()) == -1 && (!peeledTags || packedRefs.value(refName) != iter.value()))
+            return false;
+      }
+      else if (refName.startsWith("refs/heads/"))
+         mReferences.append({ iter.value(), References::Type::LocalBranch, refName.mid(11) });
+      else if (refName.startsWith("refs/remotes/") && !refName.endsWith("HEAD"))
+         mReferences.append({ iter.value(), References::Type::RemoteBranches, refName.mid(13) });
+   }
+
+   const auto head = readRefFile(QString("%1/HEAD").arg(mGitDir));
+
+   if (head.startsWith("ref: "))
+      mHeadSha = refs.value(head.mid(5));
+   else if (isSha(head))
+      mHeadSha = head;
+   else
+      return false;
+
+   return true;
+}
+
+bool ReferencesReader::readPackedRefs(QHash<QString, QString> &refs, QHash<QString, QString> &peeled,
+                                      bool &peeledTags) const
+{
+   QFile file(QString("%1/packed-refs").arg(mCommonDir));
+
+   if (!file.exists())
+      return true;
+
+   if (!file.open(QIODevice::ReadOnly))
+      return false;
+
+   const auto size = file.size();
+
+   if (size == 0)
+      return true;
+
+   const auto data = file.map(0, size);
+
+   if (!data)
+      return false;
+
+   const auto content = QByteArray::fromRawData(reinterpret_cast<const char *>(data), size);
+   QString lastRef;
+   auto valid = true;
+   qsizetype start = 0;
+
+   while (valid && start < content.size())
+   {
+      auto end = content.indexOf('\n', start);
+
+      if (end == -1)
+         end = content.size();
+
+      const auto line = QByteArray::fromRawData(content.constData() + start, end - start).trimmed();
+      start = end + 1;
+
+      if (line.isEmpty())
+         continue;
+
+      if (line.startsWith('#'))
+      {
+         // With the "peeled" trait every annotated tag has its peeled line, so a tag without it is lightweight.
+         const auto traits = line.split(' ');
+         peeledTags = traits.contains("peeled") || traits.contains("fully-peeled");
+      }
+      else if (line.startsWith('^'))
+      {
+         const auto sha = QString::fromUtf8(line.mid(1));
+         valid = !lastRef.isEmpty() && isSha(sha);
+
+         if (valid)
+            peeled.insert(lastRef, sha);
+      }
+      else
+      {
+         const auto separator = line.indexOf(' ');
+         const auto sha = QString::fromUtf8(line.left(separator));
+
+         valid = separator != -1 && isSha(sha);
+
+         if (valid)
+         {
+            lastRef = QString::fromUtf8(line.mid(separator + 1));
+            refs.insert(lastRef, sha);
+         }
+      }
+   }
+
+   file.unmap(data);
+
+   return valid;
+}
+
+bool ReferencesReader::readLooseRefs(QHash<QString, QString> &refs, QHash<QString, QString> &peeled) const
+{
+   const QDir commonDir(mCommonDir);
+   const QStringList folders { "refs/heads", "refs/remotes", "refs/tags" };
+
+   for (const auto &folder : folders)
+   {
+      QDirIterator iter(commonDir.filePath(folder), QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+
+      while (iter.hasNext())
+      {
+         const auto fileName = iter.next();
+
+         // Git holds a ref.lock file while it updates a reference: it's not a reference by itself.
+         if (fileName.endsWith(QString(".lock")))
+            continue;
+
+         const auto refName = commonDir.relativeFilePath(fileName);
+         const auto content = readRefFile(fileName);
+
+         // Symbolic references (like the HEAD of the remotes) are not shown.
+         if (content.startsWith("ref: "))
+            continue;
+
+         if (!isSha(content))
+            return false;
+
+         refs.insert(refName, content);
+         peeled.remove(refName);
+      }
+   }
+
+   return true;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <References.h>
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class CommitTable;
+
+/**
+ * @brief The ReferencesReader class reads the references of the repository straight from the files of the git
+ * directory: the packed-refs file (including the peeled lines of the annotated tags), the loose references under
+ * refs/ and HEAD. It gives the same references that GitRepoLoader took from the output of git show-ref -d.
+ *
+ * When the repository stores its references in a way the reader doesn't understand (reftable, SHA-256 object names
+ * or loose annotated tags that can only be peeled by reading the object database) the read fails and git must be
+ * used instead.
+ */
+class ReferencesReader
+{
+public:
+   struct Reference
+   {
+      QString sha;
+      References::Type type;
+      QString name;
+   };
+
+   explicit ReferencesReader(const QString &gitDir);
+
+   /**
+    * @brief Reads the references of the repository.
+    *
+    * @param commits The commits of the repository, used to tell lightweight tags apart from annotated ones when the
+    * tag can't be peeled from the files.
+    * @return True if all the references were read, false if git must be used instead.
+    */
+   bool read(const CommitTable &commits);
+
+   QVector<Reference> references() const { return mReferences; }
+   QString headSha() const { return mHeadSha; }
+
+private:
+   QString mGitDir;
+   QString mCommonDir;
+   QVector<Reference> mReferences;
+   QString mHeadSha;
+
+   bool readPackedRefs(QHash<QString, QString> &refs, QHash<QString, QString> &peeled, bool &peeledTags) const;
+   bool readLooseRefs(QHash<QString, QString> &refs, QHash<QString, QString> &peeled) const;
+};
@@ -0,0 +1,150 @@
+#include "RevisionFilesCache.h"
+
+#include <QLogger.h>
+
+#include <algorithm>
+
+using namespace QLogger;
+
+namespace
+{
+const quint64 LOG_LOOKUPS = 500;
+
+/**
+ * @brief Estimates the memory taken by an entry: the key, the file names and the per-file status data.
+ */
+qint64 estimateBytes(const RevisionFilesCache::Key &key, const RevisionFiles &files)
+{
+   static constexpr qint64 ENTRY_OVERHEAD = 128;
+   static constexpr qint64 FILE_OVERHEAD = 48;
+
+   auto bytes
+       = ENTRY_OVERHEAD + static_cast<qint64>(sizeof(RevisionFiles)) + (key.first.size() + key.second.size()) * 2;
+
+   for (auto i = 0; i < files.count(); ++i)
+      bytes += FILE_OVERHEAD + files.getFile(i).size() * 2;
+
+   return bytes;
+}
+}
+
+void RevisionFilesCache::setBudget(qint64 bytes)
+{
+   mBudget = std::max<qint64>(bytes, 0);
+
+   evict();
+}
+
+std::optional<RevisionFiles> RevisionFilesCache::find(const Key &key)
+{
+   std::optional<RevisionFiles> files;
+
+   if (const auto iter = mIndex.constFind(key); iter != mIndex.cend())
+   {
+      ++mHits;
+
+      mEntries.splice(mEntries.begin(), mEntries, *iter);
+      files = mEntries.front().files;
+   }
+   else
+      ++mMisses;
+
+   if ((mHits + mMisses) % LOG_LOOKUPS == 0)
+      logStatistics();
+
+   return files;
+}
+
+bool RevisionFilesCache::insert(const Key &key, const RevisionFiles &files, bool pinned)
+{
+   if (const auto iter = mIndex.constFind(key); iter != mIndex.cend())
+   {
+      const auto entry = *iter;
+
+      mEntries.splice(mEntries.begin(), mEntries, entry);
+
+      if (entry->files == files && entry->pinned == pinned)
+         return false;
+
+      mBytes -= entry->bytes;
+      mEntries.erase(entry);
+      mIndex.remove(key);
+   }
+
+   // Only the last pinned entry of a commit is kept: the older ones (the WIP against a previous parent) can be dropped.
+   if (pinned)
+   {
+      for (auto &entry : mEntries)
+      {
+         if (entry.pinned && entry.key.first == key.first)
+            entry.pinned = false;
+      }
+   }
+
+   const auto bytes = estimateBytes(key, files);
+
+   mEntries.push_front({ key, files, bytes, pinned });
+   mIndex.insert(key, mEntries.begin());
+   mBytes += bytes;
+
+   evict();
+
+   return true;
+}
+
+void RevisionFilesCache::clear()
+{
+   logStatistics();
+
+   mEntries.clear();
+   mIndex.clear();
+   mIndex.squeeze();
+   mBytes = 0;
+   mHits = 0;
+   mMisses = 0;
+}
+
+void RevisionFilesCache::evict()
+{
+   auto evicted = 0;
+
+   // The most recent entry is always kept, even when it's bigger than the whole budget.
+   for (auto iter = mEntries.end(); mBytes > mBudget && iter != mEntries.begin();)
+   {
+      --iter;
+
+      if (iter == mEntries.begin())
+         break;
+
+      if (!iter->pinned)
+      {
+         mBytes -= iter->bytes;
+         mIndex.remove(iter->key);
+         iter = mEntries.erase(iter);
+         ++evicted;
+      }
+   }
+
+   if (evicted > 0)
+   {
+      QLog_Debug("Cache",
+                 QString("Dropped {%1} revision file lists to stay within {%2} KB.").arg(evicted).arg(mBudget / 1024));
+   }
+}
+
+void RevisionFilesCache::logStatistics() const
+{
+   const auto lookups = mHits + mMisses;
+
+   if (lookups == 0)
+      return;
+
+   QLog_Debug("Cache",
+              QString("Revision files: {%1} hits, {%2} misses ({%3}% hit rate), {%4} lists, {%5} of {%6} KB.")
+                  .arg(mHits)
+                  .arg(mMisses)
+                  .arg(mHits * 100 / lookups)
+                  .arg(mIndex.count())
+                  .arg(mBytes / 1024)
+                  .arg(mBudget / 1024));
+}
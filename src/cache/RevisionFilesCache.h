@@ -0,0 +1,95 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <RevisionFiles.h>
+
+#include <QHash>
+#include <QPair>
+#include <QString>
+
+#include <list>
+#include <optional>
+
+/**
+ * @brief The RevisionFilesCache class keeps the lists of files changed between two commits within a budget of memory.
+ * When the estimated size of the lists goes over the budget, the ones used least recently are dropped. The pinned
+ * entries (the WIP) are never dropped, and the hits and misses of the lookups are logged from time to time.
+ *
+ * The class is not thread-safe: GitCache guards it with its own mutex.
+ */
+class RevisionFilesCache
+{
+public:
+   using Key = QPair<QString, QString>;
+
+   static constexpr qint64 DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+   /**
+    * @brief Sets the memory budget, dropping the entries over it.
+    *
+    * @param bytes The budget in bytes.
+    */
+   void setBudget(qint64 bytes);
+   qint64 budget() const { return mBudget; }
+   qint64 size() const { return mBytes; }
+   int count() const { return static_cast<int>(mIndex.count()); }
+   bool contains(const Key &key) const { return mIndex.contains(key); }
+
+   /**
+    * @brief Looks up an entry and marks it as the most recently used.
+    *
+    * @return The files if they are in the cache.
+    */
+   std::optional<RevisionFiles> find(const Key &key);
+
+   /**
+    * @brief Adds or replaces an entry. A pinned entry is not dropped until it's unpinned by another pinned one whose
+    * first SHA is the same.
+    *
+    * @return True if the entry was added or its files changed, false if it was already stored with the same files.
+    */
+   bool insert(const Key &key, const RevisionFiles &files, bool pinned = false);
+   void clear();
+
+private:
+   struct Entry
+   {
+      Key key;
+      RevisionFiles files;
+      qint64 bytes = 0;
+      bool pinned = false;
+   };
+
+   std::list<Entry> mEntries; // From the most to the least recently used.
+   QHash<Key, std::list<Entry>::iterator> mIndex;
+   qint64 mBudget = DEFAULT_BUDGET;
+   qint64 mBytes = 0;
+   quint64 mHits = 0;
+   quint64 mMisses = 0;
+
+   void evict();
+   void logStatistics() const;
+};
@@ -0,0 +1,87 @@
+#include "RevisionFilesPrefetcher.h"
+
+#include <GitBase.h>
+#include <GitCache.h>
+#include <GitHistory.h>
+#include <RevisionFiles.h>
+
+#include <QLogger.h>
+
+using namespace QLogger;
+
+RevisionFilesPrefetcher::RevisionFilesPrefetcher(const QSharedPointer<GitBase> &git,
+                                                 const QSharedPointer<GitCache> &cache, QObject *parent)
+   : QThread(parent)
+   , mGit(git)
+   , mCache(cache)
+{
+}
+
+RevisionFilesPrefetcher::~RevisionFilesPrefetcher()
+{
+   {
+      QMutexLocker lock(&mMutex);
+      mStop = true;
+      mPending.clear();
+      mCondition.wakeAll();
+   }
+
+   wait();
+}
+
+void RevisionFilesPrefetcher::prefetch(const QVector<Key> &keys)
+{
+   {
+      QMutexLocker lock(&mMutex);
+      mPending = keys;
+      mCondition.wakeAll();
+   }
+
+   if (!isRunning())
+      start(QThread::LowPriority);
+}
+
+void RevisionFilesPrefetcher::cancel()
+{
+   QMutexLocker lock(&mMutex);
+   mPending.clear();
+}
+
+void RevisionFilesPrefetcher::run()
+{
+   QScopedPointer<GitHistory> git(new GitHistory(mGit));
+   auto fetched = 0;
+
+   forever
+   {
+      Key key;
+
+      {
+         QMutexLocker lock(&mMutex);
+
+         if (mPending.isEmpty() && fetched > 0)
+         {
+            QLog_Debug("Cache", QString("Prefetched the files of {%1} commits.").arg(fetched));
+            fetched = 0;
+         }
+
+         while (mPending.isEmpty() && !mStop)
+            mCondition.wait(&mMutex);
+
+         if (mStop)
+            return;
+
+         key = mPending.takeFirst();
+      }
+
+      // The files may have been loaded by the UI or by a previous request in the meantime.
+      if (mCache->hasRevisionFiles(key.first, key.second))
+         continue;
+
+      if (const auto ret = git->getDiffFiles(key.first, key.second); ret.success)
+      {
+         mCache->insertRevisionFiles(key.first, key.second, RevisionFiles(ret.output));
+         ++fetched;
+      }
+   }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <QMutex>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+class GitBase;
+class GitCache;
+
+/**
+ * @brief The RevisionFilesPrefetcher class loads in the background the lists of files changed by the commits around the
+ * selected one, so they are already in the cache when the user moves through the history.
+ *
+ * Every new request replaces the pending one: the commits that haven't been loaded yet are dropped when the selection
+ * moves. A git call that is already running finishes and its result is stored, as it's still valid.
+ */
+class RevisionFilesPrefetcher : public QThread
+{
+   Q_OBJECT
+
+public:
+   /**
+    * @brief Number of commits before and after the selected one whose files are loaded.
+    */
+   static constexpr int DEFAULT_RANGE = 10;
+
+   using Key = QPair<QString, QString>;
+
+   explicit RevisionFilesPrefetcher(const QSharedPointer<GitBase> &git, const QSharedPointer<GitCache> &cache,
+                                    QObject *parent = nullptr);
+   ~RevisionFilesPrefetcher() override;
+
+   /**
+    * @brief Replaces the pending commits with new ones. The thread is started the first time it's called.
+    *
+    * @param keys The pairs of commit and parent SHA, in the order they have to be loaded.
+    */
+   void prefetch(const QVector<Key> &keys);
+
+   /**
+    * @brief Drops the pending commits.
+    */
+   void cancel();
+
+protected:
+   void run() override;
+
+private:
+   QSharedPointer<GitBase> mGit;
+   QSharedPointer<GitCache> mCache;
+   QMutex mMutex;
+   QWaitCondition mCondition;
+   QVector<Key> mPending;
+   bool mStop = false;
+};
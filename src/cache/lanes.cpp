@@ -8,42 +8,44 @@
 */
 #include "lanes.h"
 
-#include <QStringList>
+#include <algorithm>
+#include <utility>
 
-void Lanes::init(const QString &expectedSha)
+void Lanes::init(int expectedId)
 {
    clear();
    activeLane = 0;
-   add(LaneType::BRANCH, expectedSha, activeLane);
+   add(LaneType::BRANCH, expectedId, activeLane);
 }
 
 void Lanes::clear()
 {
    typeVec.clear();
    typeVec.squeeze();
-   nextShaVec.clear();
-   nextShaVec.squeeze();
+   nextIdVec.clear();
+   nextIdVec.squeeze();
+   lanesById.clear();
 }
 
-bool Lanes::isFork(const QString &sha, bool &isDiscontinuity)
+bool Lanes::isFork(int id, bool &isDiscontinuity)
 {
-   int pos = findNextSha(sha, 0);
+   int pos = findNextId(id, 0);
    isDiscontinuity = activeLane != pos;
 
-   return pos == -1 ? false : findNextSha(sha, pos + 1) != -1;
+   return pos == -1 ? false : findNextId(id, pos + 1) != -1;
 }
 
-void Lanes::setFork(const QString &sha)
+void Lanes::setFork(int id)
 {
    auto rangeEnd = 0;
    auto idx = 0;
-   auto rangeStart = rangeEnd = idx = findNextSha(sha, 0);
+   auto rangeStart = rangeEnd = idx = findNextId(id, 0);
 
    while (idx != -1)
    {
       rangeEnd = idx;
       typeVec[idx].setType(LaneType::TAIL);
-      idx = findNextSha(sha, idx + 1);
+      idx = findNextId(id, idx + 1);
    }
 
    typeVec[activeLane].setType(NODE);
@@ -79,7 +81,7 @@ void Lanes::setFork(const QString &sha)
    }
 }
 
-void Lanes::setMerge(const QStringList &parents)
+void Lanes::setMerge(const QVector<int> &parents)
 {
    auto &t = typeVec[activeLane];
    auto wasFork = t.equals(NODE);
@@ -92,11 +94,11 @@ void Lanes::setMerge(const QStringList &parents)
 
    auto rangeStart = activeLane;
    auto rangeEnd = activeLane;
-   QStringList::const_iterator it(parents.constBegin());
+   auto it = parents.constBegin();
 
    for (++it; it != parents.constEnd(); ++it)
    { // skip first parent
-      int idx = findNextSha(*it, 0);
+      int idx = findNextId(*it, 0);
 
       if (idx != -1)
       {
@@ -160,7 +162,7 @@ void Lanes::setInitial()
       t.setType(LaneType::INITIAL);
 }
 
-void Lanes::changeActiveLane(const QString &sha)
+void Lanes::changeActiveLane(int id)
 {
    auto &t = typeVec[activeLane];
 
@@ -169,11 +171,11 @@ void Lanes::changeActiveLane(const QString &sha)
    else
       t.setType(LaneType::NOT_ACTIVE);
 
-   int idx = findNextSha(sha, 0);
+   int idx = findNextId(id, 0);
    if (idx != -1)
       typeVec[idx].setType(LaneType::ACTIVE);
    else
-      idx = add(LaneType::BRANCH, sha, activeLane);
+      idx = add(LaneType::BRANCH, id, activeLane);
 
    activeLane = idx;
 }
@@ -210,8 +212,9 @@ void Lanes::afterFork()
 
    while (typeVec.last().equals(LaneType::EMPTY))
    {
+      setNextId(typeVec.count() - 1, NO_COMMIT);
       typeVec.pop_back();
-      nextShaVec.pop_back();
+      nextIdVec.pop_back();
    }
 }
 
@@ -228,17 +231,52 @@ void Lanes::afterBranch()
    typeVec[activeLane].setType(LaneType::ACTIVE);
 }
 
-void Lanes::nextParent(const QString &sha)
+void Lanes::nextParent(int id)
 {
-   nextShaVec[activeLane] = sha;
+   setNextId(activeLane, id);
 }
 
-int Lanes::findNextSha(const QString &next, int pos)
+void Lanes::renameIds(const QHash<int, int> &ids)
 {
-   for (int i = pos; i < nextShaVec.count(); i++)
+   lanesById.clear();
+
+   // The lanes are visited in order, so the lists of lanes by id are built sorted.
+   for (auto pos = 0; pos < nextIdVec.count(); ++pos)
    {
-      if (nextShaVec[i] == next)
-         return i;
+      auto &next = nextIdVec[pos];
+      next = ids.value(next, next);
+
+      if (next != NO_COMMIT)
+         lanesById[next].append(pos);
+   }
+}
+
+void Lanes::shiftIds(int firstId, int count)
+{
+   // The order of the lanes doesn't change, so the lists of lanes by id stay sorted.
+   QHash<int, QVarLengthArray<int, 2>> shifted;
+
+   for (auto iter = lanesById.cbegin(); iter != lanesById.cend(); ++iter)
+      shifted.insert(iter.key() >= firstId ? iter.key() + count : iter.key(), iter.value());
+
+   for (auto &next : nextIdVec)
+   {
+      if (next >= firstId)
+         next += count;
+   }
+
+   lanesById = std::move(shifted);
+}
+
+int Lanes::findNextId(int next, int pos) const
+{
+   if (const auto lanes = lanesById.constFind(next); lanes != lanesById.cend())
+   {
+      for (const auto lane : *lanes)
+      {
+         if (lane >= pos)
+            return lane;
+      }
    }
 
    return -1;
@@ -257,7 +295,7 @@ int Lanes::findType(const LaneType type, int pos)
    return -1;
 }
 
-int Lanes::add(const LaneType type, const QString &next, int pos)
+int Lanes::add(const LaneType type, int next, int pos)
 {
    if (pos < typeVec.count())
    {
@@ -265,16 +303,37 @@ int Lanes::add(const LaneType type, const QString &next, int pos)
       if (pos != -1)
       {
          typeVec[pos].setType(type);
-         nextShaVec[pos] = next;
+         setNextId(pos, next);
          return pos;
       }
    }
 
    typeVec.append(type);
-   nextShaVec.append(next);
+   nextIdVec.append(NO_COMMIT);
+   setNextId(typeVec.count() - 1, next);
    return typeVec.count() - 1;
 }
 
+void Lanes::setNextId(int pos, int next)
+{
+   if (const auto previous = nextIdVec.at(pos); previous != NO_COMMIT)
+   {
+      auto &lanes = lanesById[previous];
+      lanes.erase(std::find(lanes.begin(), lanes.end(), pos));
+
+      if (lanes.isEmpty())
+         lanesById.remove(previous);
+   }
+
+   nextIdVec[pos] = next;
+
+   if (next != NO_COMMIT)
+   {
+      auto &lanes = lanesById[next];
+      lanes.insert(std::lower_bound(lanes.begin(), lanes.end(), pos), pos);
+   }
+}
+
 bool Lanes::isNode(Lane lane) const
 {
    return lane.equals(NODE) || lane.equals(NODE_R) || lane.equals(NODE_L);
@@ -7,7 +7,8 @@
 #ifndef LANES_H
 #define LANES_H
 
-#include <QString>
+#include <QHash>
+#include <QVarLengthArray>
 #include <QVector>
 
 #include <LaneType.h>
@@ -15,11 +16,12 @@
 
 //
 //  At any given time, the Lanes class represents a single revision (row) of the history graph.
-//  The Lanes class contains a vector of the sha1 hashes of the next commit to appear in each lane (column).
+//  The Lanes class contains a vector of the ids of the next commit to appear in each lane (column). The ids are
+//  integers given by the caller, one per commit, and a hash maps every id to the lanes that expect it.
 //  The Lanes class also contains a vector used to decide which glyph to draw on the history graph.
 //
 //  For each revision (row) (from recent (top) to ancient past (bottom)), the Lanes class is updated, and the
-//  current revision (row) of glyphs is saved elsewhere (via getLanes()).
+//  current revision (row) of glyphs is saved elsewhere (via getLanes()) before the lanes move to the next row.
 //
 //  The ListView class is responsible for rendering the glyphs.
 //
@@ -29,30 +31,35 @@ class Lanes
 public:
    Lanes() = default;
    bool isEmpty() { return typeVec.empty(); }
-   void init(const QString &expectedSha);
+   static constexpr int NO_COMMIT = -1;
+
+   void init(int expectedId);
    void clear();
-   bool isFork(const QString &sha, bool &isDiscontinuity);
-   void setFork(const QString &sha);
-   void setMerge(const QStringList &parents);
+   bool isFork(int id, bool &isDiscontinuity);
+   void setFork(int id);
+   void setMerge(const QVector<int> &parents);
    void setInitial();
-   void changeActiveLane(const QString &sha);
+   void changeActiveLane(int id);
    void afterMerge();
    void afterFork();
    bool isBranch();
    void afterBranch();
-   void nextParent(const QString &sha);
-   void setLanes(QVector<Lane> &ln) { ln = typeVec; } // O(1) vector is implicitly shared
-   QVector<Lane> getLanes() const { return typeVec; }
+   void nextParent(int id);
+   void renameIds(const QHash<int, int> &ids);
+   void shiftIds(int firstId, int count);
+   const QVector<Lane> &getLanes() const { return typeVec; }
 
 private:
-   int findNextSha(const QString &next, int pos);
+   int findNextId(int next, int pos) const;
    int findType(LaneType type, int pos);
-   int add(LaneType type, const QString &next, int pos);
+   int add(LaneType type, int next, int pos);
+   void setNextId(int pos, int next);
    bool isNode(Lane lane) const;
 
    int activeLane;
    QVector<Lane> typeVec; // Describes which glyphs should be drawn.
-   QVector<QString> nextShaVec; // The sha1 hashes of the next commit to appear in each lane (column).
+   QVector<int> nextIdVec; // The ids of the next commit to appear in each lane (column).
+   QHash<int, QVarLengthArray<int, 2>> lanesById; // The lanes of nextIdVec that expect each id, sorted.
    LaneType NODE = LaneType::MERGE_FORK;
    LaneType NODE_R = LaneType::MERGE_FORK_R;
    LaneType NODE_L = LaneType::MERGE_FORK_L;
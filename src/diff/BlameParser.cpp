@@ -0,0 +1,145 @@
+#include "BlameParser.h"
+
+#include <GitExecResult.h>
+
+#include <cstring>
+
+namespace
+{
+template<qsizetype N>
+bool hasKey(const char *line, qsizetype length, const char (&key)[N])
+{
+   // The key includes the space that separates it from the value.
+   return length >= N - 1 && std::memcmp(line, key, N - 1) == 0;
+}
+
+qint64 toNumber(const char *begin, const char *end)
+{
+   qint64 number = 0;
+
+   for (auto digit = begin; digit < end && *digit >= '0' && *digit <= '9'; ++digit)
+      number = number * 10 + (*digit - '0');
+
+   return number;
+}
+}
+
+bool BlameParser::parseIncremental(const QByteArray &chunk)
+{
+   mBuffer.append(chunk);
+
+   const auto lastLineEnd = mBuffer.lastIndexOf('\n');
+
+   if (lastLineEnd == -1)
+      return false;
+
+   const auto annotatedLines = mAnnotatedLines;
+   const auto end = mBuffer.constData() + lastLineEnd;
+
+   for (auto pos = mBuffer.constData(); pos < end;)
+   {
+      const auto lineEnd = static_cast<const char *>(std::memchr(pos, '\n', end - pos + 1));
+
+      parseLine(pos, lineEnd);
+
+      pos = lineEnd + 1;
+   }
+
+   mBuffer.remove(0, lastLineEnd + 1);
+
+   return mAnnotatedLines != annotatedLines;
+}
+
+void BlameParser::clear()
+{
+   mCommits.clear();
+   mCommitIndexes.clear();
+   mLineCommits.clear();
+   mBuffer.clear();
+   mAnnotatedLines = 0;
+   mEntryCommit = -1;
+   mEntryLine = 0;
+   mEntryLines = 0;
+   mIsNewCommit = false;
+}
+
+void BlameParser::parseLine(const char *line, const char *lineEnd)
+{
+   const auto length = lineEnd - line;
+
+   if (mEntryCommit == -1)
+   {
+      // Every entry starts with: <sha> <original line> <final line> [<lines of the group>]
+      const auto shaEnd = static_cast<const char *>(std::memchr(line, ' ', length));
+
+      if (!shaEnd)
+         return;
+
+      const auto finalLineStart = static_cast<const char *>(std::memchr(shaEnd + 1, ' ', lineEnd - shaEnd - 1));
+
+      if (!finalLineStart)
+         return;
+
+      const auto linesStart
+          = static_cast<const char *>(std::memchr(finalLineStart + 1, ' ', lineEnd - finalLineStart - 1));
+
+      mEntryCommit = commitIndex(line, shaEnd - line, &mIsNewCommit);
+      mEntryLine = static_cast<int>(toNumber(finalLineStart + 1, lineEnd));
+      mEntryLines = linesStart ? static_cast<int>(toNumber(linesStart + 1, lineEnd)) : 1;
+   }
+   else if (hasKey(line, length, "filename "))
+   {
+      // The file name closes every entry.
+      annotate(mEntryLine - 1, mEntryLines, mEntryCommit);
+      mEntryCommit = -1;
+   }
+   else if (mIsNewCommit)
+   {
+      // The header of a commit is only written the first time the commit appears.
+      auto &info = mCommits[mEntryCommit];
+
+      if (hasKey(line, length, "author "))
+         info.author = QString::fromUtf8(line + 7, length - 7);
+      else if (hasKey(line, length, "author-time "))
+         info.dateTime = QDateTime::fromSecsSinceEpoch(toNumber(line + 12, lineEnd));
+      else if (hasKey(line, length, "summary ") && info.sha != ZERO_SHA)
+         info.title = QString::fromUtf8(line + 8, length - 8);
+   }
+}
+
+int BlameParser::commitIndex(const char *sha, qsizetype length, bool *isNew)
+{
+   // The raw data avoids copying the SHA of every line just to look it up.
+   const auto index = mCommitIndexes.value(QByteArray::fromRawData(sha, length), -1);
+
+   *isNew = index == -1;
+
+   if (index != -1)
+      return index;
+
+   BlameView::Commit commit;
+   commit.sha = QString::fromLatin1(sha, length);
+
+   if (commit.sha == ZERO_SHA)
+      commit.title = tr("Local changes");
+
+   mCommits.append(commit);
+   mCommitIndexes.insert(QByteArray(sha, length), static_cast<int>(mCommits.count() - 1));
+
+   return static_cast<int>(mCommits.count() - 1);
+}
+
+void BlameParser::annotate(int line, int count, int commit)
+{
+   if (line < 0 || count <= 0)
+      return;
+
+   // The entries are not written in order: the final line tells where they go.
+   if (const auto missing = line + count - mLineCommits.count(); missing > 0)
+      mLineCommits.insert(mLineCommits.count(), missing, -1);
+
+   for (auto i = line; i < line + count; ++i)
+      mLineCommits[i] = commit;
+
+   mAnnotatedLines += count;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <BlameView.h>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QHash>
+#include <QVector>
+
+/*!
+ \brief The BlameParser class parses the output of git blame --incremental in a single pass over the raw bytes, chunk by
+ chunk while git writes it. The header of a commit (author, date and summary) is only decoded the first time the commit
+ appears: the following entries of the same commit only store its index.
+
+ The entries don't have the content of the lines and come in any order: the lines that are not annotated yet have no
+ commit.
+
+*/
+class BlameParser
+{
+   Q_DECLARE_TR_FUNCTIONS(BlameParser)
+
+public:
+   /*!
+    \brief Parses the next chunk of the output of git blame --incremental. The last line of the chunk is kept until the
+    next one if it's not complete. Call \ref clear before parsing a new blame.
+
+    \param chunk The output written by git since the previous chunk.
+    \return True if any line was annotated.
+   */
+   bool parseIncremental(const QByteArray &chunk);
+   void clear();
+
+   /*!
+    \brief The commits that modified the file, each one only once.
+   */
+   const QVector<BlameView::Commit> &commits() const { return mCommits; }
+   /*!
+    \brief The index in \ref commits of the commit of every line, or -1 if the line is not annotated yet.
+   */
+   const QVector<int> &lineCommits() const { return mLineCommits; }
+   int annotatedLines() const { return mAnnotatedLines; }
+
+private:
+   QVector<BlameView::Commit> mCommits;
+   QHash<QByteArray, int> mCommitIndexes;
+   QVector<int> mLineCommits;
+   QByteArray mBuffer;
+   int mAnnotatedLines = 0;
+   int mEntryCommit = -1;
+   int mEntryLine = 0;
+   int mEntryLines = 0;
+   bool mIsNewCommit = false;
+
+   void parseLine(const char *line, const char *lineEnd);
+   int commitIndex(const char *sha, qsizetype length, bool *isNew);
+   void annotate(int line, int count, int commit);
+};
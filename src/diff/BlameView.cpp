@@ -0,0 +1,365 @@
+#include "BlameView.h"
+
+#include <GitExecResult.h>
+#include <GitQlientStyles.h>
+
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QToolTip>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace
+{
+const int kTotalColors = 8;
+const std::array<QRgb, kTotalColors> kBorderColors { { qRgb(25, 65, 99), qRgb(36, 95, 146), qRgb(44, 116, 177),
+                                                       qRgb(56, 136, 205), qRgb(87, 155, 213), qRgb(118, 174, 221),
+                                                       qRgb(150, 192, 221), qRgb(197, 220, 240) } };
+const QRgb kWipBorderColor = qRgb(216, 144, 0);
+const QRgb kBlockSeparatorColor = qRgb(96, 97, 98);
+const QRgb kNumberSeparatorColor = qRgb(32, 33, 34);
+const int kAgeBorderWidth = 5;
+const int kPadding = 2;
+const int kInfoSpacing = 15;
+const int kMaxAuthorWidth = 200;
+const int kMaxTitleWidth = 350;
+
+QString when(const QDateTime &dateTime)
+{
+   const auto now = QDateTime::currentDateTime();
+   const auto days = dateTime.daysTo(now);
+   const auto secs = dateTime.secsTo(now);
+
+   if (days > 365)
+      return BlameView::tr("%1 years ago").arg(days / 365);
+   else if (days > 30)
+      return BlameView::tr("%1 months ago").arg(days / 30);
+   else if (days > 1)
+      return BlameView::tr("%1 days ago").arg(days);
+   else if (days == 1)
+      return BlameView::tr("yesterday");
+   else if (secs > 3600)
+      return BlameView::tr("%1 hours ago").arg(secs / 3600);
+   else if (secs == 3600)
+      return BlameView::tr("1 hour ago");
+   else if (secs > 60)
+      return BlameView::tr("%1 minutes ago").arg(secs / 60);
+   else if (secs == 60)
+      return BlameView::tr("1 minute ago");
+
+   return BlameView::tr("%1 secs ago").arg(secs);
+}
+}
+
+BlameView::BlameView(QWidget *parent)
+   : QAbstractScrollArea(parent)
+{
+   viewport()->setObjectName("AnnotationFrame");
+   viewport()->setMouseTracking(true);
+
+   mInfoFont.setPointSize(9);
+
+   mCodeFont = QFont(mInfoFont);
+   mCodeFont.setFamily("DejaVu Sans Mono");
+   mCodeFont.setPointSize(8);
+
+   mLineHeight = qMax(QFontMetrics(mInfoFont).height(), QFontMetrics(mCodeFont).height()) + 2 * kPadding;
+}
+
+void BlameView::setAnnotations(const QVector<Commit> &commits, const QVector<int> &lineCommits,
+                               const QStringList &lines)
+{
+   mLines = lines;
+   mHoveredLink = -1;
+
+   const QFontMetrics codeMetrics(mCodeFont);
+
+   mNumberWidth = kAgeBorderWidth + codeMetrics.horizontalAdvance(QString::number(mLines.count())) + 2 * kPadding + 1;
+
+   const auto longestLine = std::max_element(mLines.cbegin(), mLines.cend(), [](const QString &a, const QString &b) {
+      return a.size() < b.size();
+   });
+   mCodeWidth = longestLine != mLines.cend() ? codeMetrics.horizontalAdvance(*longestLine) + 2 * kPadding : 0;
+
+   updateAnnotations(commits, lineCommits);
+}
+
+void BlameView::updateAnnotations(const QVector<Commit> &commits, const QVector<int> &lineCommits)
+{
+   mCommits = commits;
+   mLineCommits = lineCommits;
+
+   // Everything that depends on the commit is calculated once here, so painting a line only costs an index lookup.
+   auto newest = std::numeric_limits<qint64>::min();
+   auto oldest = std::numeric_limits<qint64>::max();
+
+   for (const auto &commit : mCommits)
+   {
+      if (commit.sha != ZERO_SHA)
+      {
+         newest = qMax(newest, commit.dateTime.toSecsSinceEpoch());
+         oldest = qMin(oldest, commit.dateTime.toSecsSinceEpoch());
+      }
+   }
+
+   const auto increment = newest > oldest ? qMax<qint64>((newest - oldest) / (kTotalColors - 1), 1) : 1;
+   const QFontMetrics infoMetrics(mInfoFont);
+
+   mWhen.clear();
+   mWhen.reserve(mCommits.count());
+   mColorIndexes.clear();
+   mColorIndexes.reserve(mCommits.count());
+   mDateWidth = 0;
+   mAuthorWidth = 0;
+   mTitleWidth = 0;
+
+   for (const auto &commit : mCommits)
+   {
+      if (commit.sha == ZERO_SHA)
+      {
+         mWhen.append(QString());
+         mColorIndexes.append(-1);
+      }
+      else
+      {
+         const auto colorIndex = (newest - commit.dateTime.toSecsSinceEpoch()) / increment;
+
+         mWhen.append(when(commit.dateTime));
+         mColorIndexes.append(static_cast<int>(qBound<qint64>(0, colorIndex, kTotalColors - 1)));
+      }
+
+      mDateWidth = qMax(mDateWidth, infoMetrics.horizontalAdvance(mWhen.constLast()));
+      mAuthorWidth = qMax(mAuthorWidth, infoMetrics.horizontalAdvance(commit.author));
+      mTitleWidth = qMax(mTitleWidth, infoMetrics.horizontalAdvance(commit.title));
+   }
+
+   mDateWidth += kPadding + kInfoSpacing;
+   mAuthorWidth = qMin(mAuthorWidth, kMaxAuthorWidth) + kPadding + kInfoSpacing;
+   mTitleWidth = qMin(mTitleWidth, kMaxTitleWidth) + kPadding + kInfoSpacing;
+
+   updateGeometries();
+   viewport()->update();
+}
+
+void BlameView::clear()
+{
+   setAnnotations({}, {}, {});
+}
+
+void BlameView::paintEvent(QPaintEvent *)
+{
+   QPainter painter(viewport());
+
+   if (mLines.isEmpty())
+   {
+      painter.setPen(GitQlientStyles::getTextColor());
+      painter.drawText(viewport()->rect(), Qt::AlignCenter, tr("Select a file to blame"));
+      return;
+   }
+
+   painter.translate(-horizontalScrollBar()->value(), 0);
+
+   const auto authorX = mDateWidth;
+   const auto titleX = authorX + mAuthorWidth;
+   const auto numberX = titleX + mTitleWidth;
+   const auto codeX = numberX + mNumberWidth;
+   const auto firstLine = verticalScrollBar()->value();
+   const auto lastLine = qMin(static_cast<int>(mLines.count()) - 1, firstLine + viewport()->height() / mLineHeight);
+   const auto textColor = GitQlientStyles::getTextColor();
+   auto linkFont = mInfoFont;
+   linkFont.setUnderline(true);
+
+   for (auto line = firstLine; line <= lastLine; ++line)
+   {
+      const auto y = (line - firstLine) * mLineHeight;
+      const auto commit = lineCommit(line);
+
+      if (isBlockStart(line) && commit != -1)
+      {
+         if (line > 0)
+         {
+            painter.setPen(QColor(kBlockSeparatorColor));
+            painter.drawLine(0, y, numberX, y);
+         }
+
+         const auto &info = mCommits.at(commit);
+         const QFontMetrics metrics(mInfoFont);
+
+         painter.setPen(textColor);
+         painter.setFont(mInfoFont);
+         painter.drawText(QRect(kPadding, y, mDateWidth - kPadding, mLineHeight), Qt::AlignLeft | Qt::AlignVCenter,
+                          mWhen.at(commit));
+         painter.drawText(QRect(authorX + kPadding, y, mAuthorWidth - kPadding - kInfoSpacing, mLineHeight),
+                          Qt::AlignLeft | Qt::AlignVCenter,
+                          metrics.elidedText(info.author, Qt::ElideRight, mAuthorWidth - kPadding - kInfoSpacing));
+
+         painter.setFont(mHoveredLink == line ? linkFont : mInfoFont);
+         painter.drawText(QRect(titleX + kPadding, y, mTitleWidth - kPadding - kInfoSpacing, mLineHeight),
+                          Qt::AlignLeft | Qt::AlignVCenter,
+                          metrics.elidedText(info.title, Qt::ElideRight, mTitleWidth - kPadding - kInfoSpacing));
+      }
+
+      // The lines that are not annotated yet don't have a color.
+      if (commit != -1)
+      {
+         const auto colorIndex = mColorIndexes.at(commit);
+
+         painter.fillRect(QRect(numberX, y, kAgeBorderWidth, mLineHeight),
+                          QColor(colorIndex == -1 ? kWipBorderColor : kBorderColors.at(colorIndex)));
+      }
+
+      painter.setPen(QColor(kNumberSeparatorColor));
+      painter.drawLine(codeX - 1, y, codeX - 1, y + mLineHeight);
+
+      painter.setPen(textColor);
+      painter.setFont(mCodeFont);
+      painter.drawText(QRect(numberX + kAgeBorderWidth, y, mNumberWidth - kAgeBorderWidth - kPadding - 1, mLineHeight),
+                       Qt::AlignRight | Qt::AlignVCenter, QString::number(line + 1));
+      painter.drawText(QRect(codeX + kPadding, y, mCodeWidth, mLineHeight), Qt::AlignLeft | Qt::AlignVCenter,
+                       mLines.at(line));
+   }
+}
+
+void BlameView::resizeEvent(QResizeEvent *event)
+{
+   QAbstractScrollArea::resizeEvent(event);
+
+   updateGeometries();
+}
+
+void BlameView::mouseMoveEvent(QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+   const auto link = linkAt(event->position().toPoint());
+#else
+   const auto link = linkAt(event->pos());
+#endif
+
+   if (link != mHoveredLink)
+   {
+      mHoveredLink = link;
+      viewport()->setCursor(link != -1 ? Qt::PointingHandCursor : Qt::ArrowCursor);
+      viewport()->update();
+   }
+
+   QAbstractScrollArea::mouseMoveEvent(event);
+}
+
+void BlameView::mouseReleaseEvent(QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+   const auto link = linkAt(event->position().toPoint());
+#else
+   const auto link = linkAt(event->pos());
+#endif
+
+   if (event->button() == Qt::LeftButton && link != -1)
+      emit signalCommitSelected(mCommits.at(lineCommit(link)).sha);
+
+   QAbstractScrollArea::mouseReleaseEvent(event);
+}
+
+bool BlameView::viewportEvent(QEvent *event)
+{
+   if (event->type() == QEvent::ToolTip)
+   {
+      const auto helpEvent = static_cast<QHelpEvent *>(event);
+      const auto line = lineAt(helpEvent->pos().y());
+      QString toolTip;
+
+      if (line != -1 && isBlockStart(line) && lineCommit(line) != -1)
+      {
+         const auto &commit = mCommits.at(lineCommit(line));
+
+         switch (columnAt(helpEvent->pos().x()))
+         {
+            case Column::Date:
+               toolTip = commit.dateTime.toString("dd/MM/yyyy hh:mm");
+               break;
+            case Column::Author:
+               toolTip = commit.author;
+               break;
+            case Column::Title:
+               toolTip = QString("<p>%1</p><p>%2</p>").arg(commit.sha, commit.title);
+               break;
+            default:
+               break;
+         }
+      }
+
+      if (toolTip.isEmpty())
+         QToolTip::hideText();
+      else
+         QToolTip::showText(helpEvent->globalPos(), toolTip, viewport());
+
+      return true;
+   }
+   else if (event->type() == QEvent::Leave && mHoveredLink != -1)
+   {
+      mHoveredLink = -1;
+      viewport()->setCursor(Qt::ArrowCursor);
+      viewport()->update();
+   }
+
+   return QAbstractScrollArea::viewportEvent(event);
+}
+
+void BlameView::updateGeometries()
+{
+   const auto visibleLines = qMax(viewport()->height() / mLineHeight, 1);
+   const auto totalWidth = mDateWidth + mAuthorWidth + mTitleWidth + mNumberWidth + mCodeWidth;
+
+   verticalScrollBar()->setRange(0, qMax(static_cast<int>(mLines.count()) - visibleLines, 0));
+   verticalScrollBar()->setPageStep(visibleLines);
+   verticalScrollBar()->setSingleStep(1);
+
+   horizontalScrollBar()->setRange(0, qMax(totalWidth - viewport()->width(), 0));
+   horizontalScrollBar()->setPageStep(viewport()->width());
+   horizontalScrollBar()->setSingleStep(QFontMetrics(mCodeFont).averageCharWidth());
+}
+
+int BlameView::lineAt(int y) const
+{
+   const auto line = verticalScrollBar()->value() + y / mLineHeight;
+
+   return y >= 0 && line < mLines.count() ? line : -1;
+}
+
+BlameView::Column BlameView::columnAt(int x) const
+{
+   const auto contentX = x + horizontalScrollBar()->value();
+
+   if (contentX < mDateWidth)
+      return Column::Date;
+   else if (contentX < mDateWidth + mAuthorWidth)
+      return Column::Author;
+   else if (contentX < mDateWidth + mAuthorWidth + mTitleWidth)
+      return Column::Title;
+   else if (contentX < mDateWidth + mAuthorWidth + mTitleWidth + mNumberWidth)
+      return Column::Number;
+
+   return Column::Code;
+}
+
+bool BlameView::isBlockStart(int line) const
+{
+   return line == 0 || lineCommit(line - 1) != lineCommit(line);
+}
+
+int BlameView::lineCommit(int line) const
+{
+   return line < mLineCommits.count() ? mLineCommits.at(line) : -1;
+}
+
+int BlameView::linkAt(const QPoint &pos) const
+{
+   const auto line = lineAt(pos.y());
+
+   const auto isLink = line != -1 && isBlockStart(line) && lineCommit(line) != -1 && columnAt(pos.x()) == Column::Title;
+
+   return isLink ? line : -1;
+}
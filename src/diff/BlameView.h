@@ -0,0 +1,127 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <QAbstractScrollArea>
+#include <QDateTime>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ \brief The BlameView class paints the blame of a file. It doesn't create any widget per line: the annotations are
+ stored in a compact array with the index of the commit of every line, and only the lines that fit in the viewport are
+ painted. Every block of lines that comes from the same commit shows when it was done, its author and its title, and the
+ line numbers have a color guide: the bright color indicates the more recent changes whereas the darkest color
+ indicates the oldest.
+
+ The title of the commit is a link: clicking it emits \ref signalCommitSelected.
+
+*/
+class BlameView : public QAbstractScrollArea
+{
+   Q_OBJECT
+
+signals:
+   /*!
+    \brief Signal triggered when the user clicks the title of a commit.
+
+    \param sha The SHA of the commit.
+   */
+   void signalCommitSelected(const QString &sha);
+
+public:
+   /*!
+    \brief Information of a commit that modified lines of the file. It's stored once and shared by all its lines.
+   */
+   struct Commit
+   {
+      QString sha;
+      QString author;
+      QDateTime dateTime;
+      QString title;
+   };
+
+   explicit BlameView(QWidget *parent = nullptr);
+
+   /*!
+    \brief Sets the annotated file to show.
+
+    \param commits The commits that modified the file.
+    \param lineCommits The index in \p commits of the commit of every line, or -1 if the line is not annotated yet.
+    \param lines The content of every line.
+   */
+   void setAnnotations(const QVector<Commit> &commits, const QVector<int> &lineCommits, const QStringList &lines);
+   /*!
+    \brief Updates the annotations of the file shown, keeping its content and the scroll position. It's used to show
+    the annotations while they are loaded.
+
+    \param commits The commits that modified the file.
+    \param lineCommits The index in \p commits of the commit of every line, or -1 if the line is not annotated yet.
+   */
+   void updateAnnotations(const QVector<Commit> &commits, const QVector<int> &lineCommits);
+   /*!
+    \brief Removes the file shown.
+   */
+   void clear();
+
+protected:
+   void paintEvent(QPaintEvent *event) override;
+   void resizeEvent(QResizeEvent *event) override;
+   void mouseMoveEvent(QMouseEvent *event) override;
+   void mouseReleaseEvent(QMouseEvent *event) override;
+   bool viewportEvent(QEvent *event) override;
+
+private:
+   enum class Column
+   {
+      Date,
+      Author,
+      Title,
+      Number,
+      Code
+   };
+
+   QFont mInfoFont;
+   QFont mCodeFont;
+   QVector<Commit> mCommits;
+   QVector<QString> mWhen;
+   QVector<int> mColorIndexes;
+   QVector<int> mLineCommits;
+   QStringList mLines;
+   int mLineHeight = 0;
+   int mDateWidth = 0;
+   int mAuthorWidth = 0;
+   int mTitleWidth = 0;
+   int mNumberWidth = 0;
+   int mCodeWidth = 0;
+   int mHoveredLink = -1;
+
+   void updateGeometries();
+   int lineAt(int y) const;
+   Column columnAt(int x) const;
+   bool isBlockStart(int line) const;
+   int lineCommit(int line) const;
+   int linkAt(const QPoint &pos) const;
+};
@@ -1,6 +1,8 @@
 INCLUDEPATH += $$PWD
 
 HEADERS += \
+    $$PWD/BlameParser.h \
+    $$PWD/BlameView.h \
     $$PWD/FileBlameWidget.h \
     $$PWD/FileDiffEditor.h \
     $$PWD/FileDiffWidget.h \
@@ -9,6 +11,8 @@ HEADERS += \
     $$PWD/IDiffWidget.h
 
 SOURCES += \
+    $$PWD/BlameParser.cpp \
+    $$PWD/BlameView.cpp \
     $$PWD/FileBlameWidget.cpp \
     $$PWD/FileDiffEditor.cpp \
     $$PWD/FileDiffWidget.cpp \
@@ -1,27 +1,22 @@
 #include "FileBlameWidget.h"
 
-#include <ButtonLink.hpp>
-#include <CommitInfo.h>
-#include <GitCache.h>
-#include <GitHistory.h>
+#include <BlameView.h>
+#include <GitBase.h>
+#include <GitExecResult.h>
 
+#include <QDir>
+#include <QFile>
 #include <QGridLayout>
 #include <QLabel>
 #include <QMessageBox>
-#include <QScrollArea>
-#include <QtMath>
-
-#include <array>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QProgressBar>
+#include <QTimer>
 
 namespace
 {
-static const int kTotalColors = 8;
-static const std::array<const char *, kTotalColors> kBorderColors { { "25, 65, 99", "36, 95, 146", "44, 116, 177",
-                                                                      "56, 136, 205", "87, 155, 213", "118, 174, 221",
-                                                                      "150, 192, 221", "197, 220, 240" } };
-qint64 kSecondsNewest = 0;
-qint64 kSecondsOldest = QDateTime::currentDateTime().toSecsSinceEpoch();
-qint64 kIncrementSecs = 0;
+const int UPDATE_INTERVAL_MS = 100;
 }
 
 FileBlameWidget::FileBlameWidget(const QSharedPointer<GitCache> &cache, const QSharedPointer<GitBase> &git,
@@ -29,28 +24,24 @@ FileBlameWidget::FileBlameWidget(const QSharedPointer<GitCache> &cache, const QS
    : QFrame(parent)
    , mCache(cache)
    , mGit(git)
-   , mAnotation(new QFrame())
    , mCurrentSha(new QLabel())
    , mPreviousSha(new QLabel())
+   , mBlameView(new BlameView())
+   , mProgress(new QProgressBar())
+   , mUpdateTimer(new QTimer(this))
 {
    setAttribute(Qt::WA_DeleteOnClose);
 
-   mAnotation->setObjectName("AnnotationFrame");
-
-   auto initialLayout = new QGridLayout(mAnotation);
-   initialLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Expanding), 0, 0);
-   initialLayout->addWidget(new QLabel(tr("Select a file to blame")), 1, 1);
-   initialLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Expanding), 2, 2);
-
-   mInfoFont.setPointSize(9);
+   connect(mBlameView, &BlameView::signalCommitSelected, this, &FileBlameWidget::signalCommitSelected);
 
-   mCodeFont = QFont(mInfoFont);
-   mCodeFont.setFamily("DejaVu Sans Mono");
-   mCodeFont.setPointSize(8);
+   mProgress->setFormat(tr("Blaming... %p%"));
+   mProgress->setMaximumWidth(200);
+   mProgress->setVisible(false);
 
-   mScrollArea = new QScrollArea();
-   mScrollArea->setWidget(mAnotation);
-   mScrollArea->setWidgetResizable(true);
+   // The annotations are shown in batches so the view isn't updated on every entry that git writes.
+   mUpdateTimer->setSingleShot(true);
+   mUpdateTimer->setInterval(UPDATE_INTERVAL_MS);
+   connect(mUpdateTimer, &QTimer::timeout, this, &FileBlameWidget::updateAnnotations);
 
    const auto lSha = new QLabel(tr("Current SHA:"));
    const auto lSha2 = new QLabel(tr("Previous SHA:"));
@@ -64,258 +55,206 @@ FileBlameWidget::FileBlameWidget(const QSharedPointer<GitCache> &cache, const QS
    shasLayout->addWidget(lSha, 0, 0);
    shasLayout->addWidget(mCurrentSha, 0, 1);
    shasLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Fixed), 0, 2);
+   shasLayout->addWidget(mProgress, 0, 3);
    shasLayout->addWidget(lSha2, 1, 0);
    shasLayout->addWidget(mPreviousSha, 1, 1);
-   shasLayout->addWidget(separator, 2, 0, 1, 3);
+   shasLayout->addWidget(separator, 2, 0, 1, 4);
 
    const auto layout = new QVBoxLayout(this);
    layout->setContentsMargins(10, 10, 10, 0);
    layout->setSpacing(0);
    layout->addLayout(shasLayout);
-   layout->addWidget(mScrollArea);
+   layout->addWidget(mBlameView);
 }
 
-void FileBlameWidget::setup(const QString &fileName, const QString &currentSha, const QString &previousSha)
+FileBlameWidget::~FileBlameWidget()
 {
-   mCurrentFile = fileName;
-   QScopedPointer<GitHistory> git(new GitHistory(mGit));
-   const auto ret = git->blame(mCurrentFile, currentSha);
-
-   if (ret.success && !ret.output.startsWith("fatal:"))
-   {
-      delete mAnotation;
-      mAnotation = nullptr;
-
-      mCurrentSha->setText(currentSha);
-      mPreviousSha->setText(previousSha);
-
-      const auto annotations = processBlame(ret.output);
-      formatAnnotatedFile(annotations);
-   }
-   else
-      QMessageBox::warning(
-          this, tr("File not in Git"),
-          tr("The file {%1} is not under Git control version. You cannot blame it.").arg(mCurrentFile));
-}
-
-void FileBlameWidget::reload(const QString &currentSha, const QString &previousSha)
-{
-   setup(mCurrentFile, currentSha, previousSha);
+   cancel();
 }
 
-QString FileBlameWidget::getCurrentSha() const
-{
-   return mCurrentSha->text();
-}
-
-QVector<FileBlameWidget::Annotation> FileBlameWidget::processBlame(const QString &blame)
+void FileBlameWidget::setup(const QString &fileName, const QString &currentSha, const QString &previousSha)
 {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-   const auto lines = blame.split("\n", Qt::SkipEmptyParts);
-#else
-   const auto lines = blame.split("\n", QString::SkipEmptyParts);
-#endif
-   QVector<Annotation> annotations;
-
-   for (const auto &line : lines)
-   {
-      auto start = 0;
-      auto indexOfTab = line.indexOf('\t');
-      const auto shortSha = line.mid(start, indexOfTab);
-      const auto revision = mCache->commitInfo(shortSha);
-
-      start = indexOfTab + 1;
-      indexOfTab = line.indexOf('\t', start);
-      const auto name = line.mid(start, indexOfTab - start).remove("(");
-
-      start = indexOfTab + 1;
-      indexOfTab = line.indexOf('\t', start);
-      const auto dtValue = line.mid(start, indexOfTab - start);
-      const auto dt = QDateTime::fromString(dtValue, Qt::ISODate);
+   cancel();
 
-      start = indexOfTab + 1;
+   mCurrentFile = fileName;
+   mCurrentSha->setText(currentSha);
+   mPreviousSha->setText(previousSha);
+   mParser.clear();
+   mBlameView->clear();
+   mContentLoaded = false;
+   mBlameFinished = false;
 
-      const auto lineNumAndContent = line.mid(start);
-      const auto divisorChar = lineNumAndContent.indexOf(")");
-      const auto lineText = lineNumAndContent.mid(0, divisorChar);
-      const auto content = lineNumAndContent.mid(divisorChar + 1, lineNumAndContent.length() - lineText.length() - 1);
+   QStringList args { "blame", "--incremental" };
 
-      annotations.append({ revision.sha, name, dt, lineText.toInt(), content });
+   if (currentSha != ZERO_SHA)
+      args.append(currentSha);
 
-      if (revision.sha != ZERO_SHA)
-      {
-         const auto dtSinceEpoch = dt.toSecsSinceEpoch();
+   args << "--" << mCurrentFile;
 
-         if (kSecondsNewest < dtSinceEpoch)
-            kSecondsNewest = dtSinceEpoch;
+   mBlameProcess = createGitProcess();
 
-         if (kSecondsOldest > dtSinceEpoch)
-            kSecondsOldest = dtSinceEpoch;
-      }
-   }
+   connect(mBlameProcess, &QProcess::readyReadStandardOutput, this, &FileBlameWidget::processBlameOutput);
+   connect(mBlameProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+           [this](int exitCode) { processBlameFinished(exitCode == 0); });
+   connect(mBlameProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+      if (error == QProcess::FailedToStart)
+         processBlameFinished(false);
+   });
 
-   kIncrementSecs = kSecondsNewest != kSecondsOldest ? (kSecondsNewest - kSecondsOldest) / (kTotalColors - 1) : 1;
+   // The progress is set before starting, since a process that fails to start finishes the blame inside start().
+   mProgress->setValue(0);
+   mProgress->setVisible(true);
 
-   return annotations;
-}
+   mBlameProcess->start("git", args);
 
-void FileBlameWidget::formatAnnotatedFile(const QVector<Annotation> &annotations)
-{
-   auto labelRow = 0;
-   QLabel *dateLabel = nullptr;
-   QLabel *authorLabel = nullptr;
-   ButtonLink *messageLabel = nullptr;
+   if (!mBlameProcess)
+      return;
 
-   const auto annotationLayout = new QGridLayout();
-   annotationLayout->setContentsMargins(QMargins());
-   annotationLayout->setSpacing(0);
+   // The content is shown right away and the annotations are added while the blame runs.
+   if (currentSha == ZERO_SHA)
+   {
+      QFile file(QDir(mGit->getWorkingDir()).absoluteFilePath(mCurrentFile));
 
-   const auto totalAnnot = annotations.count();
-   for (auto row = 0; row < totalAnnot; ++row)
+      if (file.open(QIODevice::ReadOnly))
+         showContent(file.readAll());
+      else
+         processContentFailed();
+   }
+   else
    {
-      const auto &lastAnnotation = row == 0 ? Annotation() : annotations.at(row - 1);
+      const auto revisionFile = QDir(mGit->getWorkingDir()).relativeFilePath(mCurrentFile);
 
-      if (lastAnnotation.sha != annotations.at(row).sha)
-      {
-         if (dateLabel)
-            annotationLayout->addWidget(dateLabel, labelRow, 0);
+      mContentProcess = createGitProcess();
 
-         if (authorLabel)
-            annotationLayout->addWidget(authorLabel, labelRow, 1);
+      connect(mContentProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, [this](int exitCode) {
+         const auto content = mContentProcess->readAllStandardOutput();
 
-         if (messageLabel)
-            annotationLayout->addWidget(messageLabel, labelRow, 2);
+         mContentProcess->deleteLater();
+         mContentProcess = nullptr;
 
-         dateLabel = createDateLabel(annotations.at(row), row == 0);
-         authorLabel = createAuthorLabel(annotations.at(row).author, row == 0);
-         messageLabel = createMessageLabel(annotations.at(row).sha, row == 0);
+         if (exitCode == 0)
+            showContent(content);
+         else
+            processContentFailed();
+      });
+      connect(mContentProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+         if (error == QProcess::FailedToStart)
+         {
+            mContentProcess->deleteLater();
+            mContentProcess = nullptr;
 
-         labelRow = row;
-      }
+            processContentFailed();
+         }
+      });
 
-      annotationLayout->addWidget(createNumLabel(annotations.at(row), row), row, 3);
-      annotationLayout->addWidget(createCodeLabel(annotations.at(row).content), row, 4);
+      mContentProcess->start("git", { "show", QString("%1:%2").arg(currentSha, revisionFile) });
    }
+}
 
-   // Adding the last row
-   if (dateLabel)
-      annotationLayout->addWidget(dateLabel, labelRow, 0);
-
-   if (authorLabel)
-      annotationLayout->addWidget(authorLabel, labelRow, 1);
-
-   if (messageLabel)
-      annotationLayout->addWidget(messageLabel, labelRow, 2);
-
-   annotationLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Expanding), totalAnnot, 4);
-
-   mAnotation = new QFrame();
-   mAnotation->setObjectName("AnnotationFrame");
-   mAnotation->setLayout(annotationLayout);
+void FileBlameWidget::reload(const QString &currentSha, const QString &previousSha)
+{
+   setup(mCurrentFile, currentSha, previousSha);
+}
 
-   mScrollArea->setWidget(mAnotation);
-   mScrollArea->setWidgetResizable(true);
+QString FileBlameWidget::getCurrentSha() const
+{
+   return mCurrentSha->text();
 }
 
-QLabel *FileBlameWidget::createDateLabel(const Annotation &annotation, bool isFirst)
+void FileBlameWidget::cancel()
 {
-   auto isWip = annotation.sha == ZERO_SHA;
-   QString when;
+   mUpdateTimer->stop();
+   mProgress->setVisible(false);
 
-   if (!isWip)
+   for (auto process : { mContentProcess, mBlameProcess })
    {
-      const auto days = annotation.dateTime.daysTo(QDateTime::currentDateTime());
-      const auto secs = annotation.dateTime.secsTo(QDateTime::currentDateTime());
-      if (days > 365)
-         when.append(tr("%1 years ago").arg(days / 365));
-      else if (days > 30)
-         when.append(tr("%1 months ago").arg(days / 30));
-      else if (days > 1)
-         when.append(tr("%1 days ago").arg(days));
-      else if (days == 1)
-         when.append(tr("yesterday"));
-      else if (secs > 3600)
-         when.append(tr("%1 hours ago").arg(secs / 3600));
-      else if (secs == 3600)
-         when.append(tr("1 hour ago"));
-      else if (secs > 60)
-         when.append(tr("%1 secs / 60minutes ago"));
-      else if (secs == 60)
-         when.append(tr("1 minute ago"));
-      else
-         when.append(tr("%1 secs ago").arg(secs));
+      if (process)
+      {
+         process->disconnect(this);
+         process->kill();
+         process->deleteLater();
+      }
    }
 
-   const auto dateLabel = new QLabel(when);
-   dateLabel->setObjectName(isFirst ? QString("authorPrimusInterPares") : QString("authorFirstOfItsName"));
-   dateLabel->setToolTip(annotation.dateTime.toString("dd/MM/yyyy hh:mm"));
-   dateLabel->setFont(mInfoFont);
-   dateLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+   mContentProcess = nullptr;
+   mBlameProcess = nullptr;
+}
 
-   return dateLabel;
+void FileBlameWidget::resume()
+{
+   if (!mBlameFinished && !mBlameProcess && !mCurrentFile.isEmpty())
+      setup(mCurrentFile, mCurrentSha->text(), mPreviousSha->text());
 }
 
-QLabel *FileBlameWidget::createAuthorLabel(const QString &author, bool isFirst)
+QProcess *FileBlameWidget::createGitProcess()
 {
-   const auto authorLabel = new QLabel(author);
-   authorLabel->setObjectName(isFirst ? QString("authorPrimusInterPares") : QString("authorFirstOfItsName"));
-   authorLabel->setFont(mInfoFont);
-   authorLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+   // Without it git buffers the output of the pipe and the annotations would only arrive at the end.
+   auto environment = QProcessEnvironment::systemEnvironment();
+   environment.insert("GIT_FLUSH", "1");
+
+   const auto process = new QProcess(this);
+   process->setWorkingDirectory(mGit->getWorkingDir());
+   process->setProcessEnvironment(environment);
 
-   return authorLabel;
+   return process;
 }
 
-ButtonLink *FileBlameWidget::createMessageLabel(const QString &sha, bool isFirst)
+void FileBlameWidget::showContent(const QByteArray &content)
 {
-   const auto revision = mCache->commitInfo(sha);
-   auto commitMsg = tr("Local changes");
+   auto lines = QString::fromUtf8(content).split("\n");
 
-   if (!revision.sha.isEmpty())
-   {
-      auto log = revision.shortLog;
+   if (!lines.isEmpty() && lines.constLast().isEmpty())
+      lines.removeLast();
 
-      if (log.length() > 47)
-         log = log.left(47) + QString("...");
-
-      commitMsg = log;
-   }
+   mContentLoaded = true;
+   mProgress->setRange(0, qMax(static_cast<int>(lines.count()), 1));
+   mBlameView->setAnnotations(mParser.commits(), mParser.lineCommits(), lines);
+}
 
-   const auto messageLabel = new ButtonLink(commitMsg);
-   messageLabel->setObjectName(isFirst ? QString("primusInterPares") : QString("firstOfItsName"));
-   messageLabel->setToolTip(QString("<p>%1</p><p>%2</p>").arg(sha, commitMsg));
-   messageLabel->setFont(mInfoFont);
+void FileBlameWidget::processContentFailed()
+{
+   // Without the content the annotations have nowhere to be shown, and resuming the tab would only fail again.
+   cancel();
+   mBlameFinished = true;
 
-   connect(messageLabel, &ButtonLink::clicked, this, [this, sha]() { emit signalCommitSelected(sha); });
+   QMessageBox::warning(this, tr("Blame not available"),
+                        tr("The content of the file {%1} couldn't be read at the commit {%2}.")
+                            .arg(mCurrentFile, mCurrentSha->text()));
+}
 
-   return messageLabel;
+void FileBlameWidget::processBlameOutput()
+{
+   if (mParser.parseIncremental(mBlameProcess->readAllStandardOutput()) && !mUpdateTimer->isActive())
+      mUpdateTimer->start();
 }
 
-QLabel *FileBlameWidget::createNumLabel(const Annotation &annotation, int row)
+void FileBlameWidget::processBlameFinished(bool success)
 {
-   const auto numberLabel = new QLabel(QString::number(row + 1));
-   numberLabel->setFont(mCodeFont);
-   numberLabel->setSizePolicy(QSizePolicy::Preferred, QSizePolicy::MinimumExpanding);
-   numberLabel->setObjectName("numberLabel");
-   numberLabel->setAlignment(Qt::AlignVCenter | Qt::AlignRight);
+   if (success)
+      mParser.parseIncremental(mBlameProcess->readAllStandardOutput());
 
-   if (annotation.sha != ZERO_SHA)
+   mBlameProcess->deleteLater();
+   mBlameProcess = nullptr;
+   mBlameFinished = true;
+   mProgress->setVisible(false);
+
+   updateAnnotations();
+
+   if (!success)
    {
-      const auto dtSinceEpoch = annotation.dateTime.toSecsSinceEpoch();
-      const auto colorIndex = qCeil((kSecondsNewest - dtSinceEpoch) / kIncrementSecs);
-      numberLabel->setStyleSheet(
-          QString("QLabel { border-left: 5px solid rgb(%1) }").arg(QString::fromUtf8(kBorderColors.at(colorIndex))));
+      QMessageBox::warning(
+          this, tr("File not in Git"),
+          tr("The file {%1} is not under Git control version. You cannot blame it.").arg(mCurrentFile));
    }
-   else
-      numberLabel->setStyleSheet("QLabel { border-left: 5px solid #D89000 }");
-
-   return numberLabel;
 }
 
-QLabel *FileBlameWidget::createCodeLabel(const QString &content)
+void FileBlameWidget::updateAnnotations()
 {
-   const auto contentLabel = new QLabel(content);
-   contentLabel->setFont(mCodeFont);
-   contentLabel->setObjectName("normalLabel");
+   mUpdateTimer->stop();
 
-   return contentLabel;
+   if (mContentLoaded)
+   {
+      mBlameView->updateAnnotations(mParser.commits(), mParser.lineCommits());
+      mProgress->setValue(qMin(mParser.annotatedLines(), mProgress->maximum()));
+   }
 }
@@ -23,14 +23,17 @@
  ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  ***************************************************************************************/
 
+#include <BlameParser.h>
+
 #include <QFrame>
-#include <QDateTime>
 
 class GitBase;
-class QScrollArea;
-class ButtonLink;
+class BlameView;
 class QLabel;
 class GitCache;
+class QProcess;
+class QProgressBar;
+class QTimer;
 
 /*!
  \brief The FileBalmeWidget class is the widget that creates the view for the blame of a file. It is formed by two
@@ -61,11 +64,18 @@ public:
    */
    explicit FileBlameWidget(const QSharedPointer<GitCache> &cache, const QSharedPointer<GitBase> &git,
                             QWidget *parent = nullptr);
+   /*!
+    \brief Destructor. Cancels the blame in progress.
+   */
+   ~FileBlameWidget() override;
 
    /*!
     \brief Sets up the widget by providing the file to blame and the last commit SHA where the file was modified. The
     previous sha is passed for general information.
 
+    The content of the file is shown as soon as it's read and the blame runs in the background: the annotations are
+    shown while git finds them. A blame in progress is cancelled.
+
     \param fileName The file name to blame.
     \param currentSha The last commit SHA where the file was modified.
     \param previousSha The previous commit SHA where the file was modified.
@@ -91,83 +101,34 @@ public:
     \return QString The file being displayed.
    */
    QString getCurrentFile() const { return mCurrentFile; }
+   /*!
+    \brief Cancels the blame in progress. The annotations found so far are kept.
+   */
+   void cancel();
+   /*!
+    \brief Starts the blame again if it was cancelled before it finished.
+   */
+   void resume();
 
 private:
    QSharedPointer<GitCache> mCache;
    QSharedPointer<GitBase> mGit;
-   QFrame *mAnotation = nullptr;
    QLabel *mCurrentSha = nullptr;
    QLabel *mPreviousSha = nullptr;
-   QScrollArea *mScrollArea = nullptr;
-   QFont mInfoFont;
-   QFont mCodeFont;
+   BlameView *mBlameView = nullptr;
+   QProgressBar *mProgress = nullptr;
+   QTimer *mUpdateTimer = nullptr;
+   QProcess *mContentProcess = nullptr;
+   QProcess *mBlameProcess = nullptr;
+   BlameParser mParser;
    QString mCurrentFile;
-
-   /*!
-    \brief Private class that stores data of a annotation. An annotation is the information regarding when a line was
-    last modified.
-
-   */
-   struct Annotation
-   {
-      QString sha;
-      QString author;
-      QDateTime dateTime;
-      int line = 0;
-      QString content;
-   };
-
-   /*!
-    \brief Processes a blame converting the git output into a vector of annotations per each line.
-
-    \param blame The git blame output.
-    \return QVector<Annotation> Vector of the annotations for every line.
-   */
-   QVector<Annotation> processBlame(const QString &blame);
-   /*!
-    \brief Process all the \p annotations and creates the view of the file with that information.
-
-    \param annotations The annotations to process.
-   */
-   void formatAnnotatedFile(const QVector<Annotation> &annotations);
-   /*!
-    \brief Factory method that creates a label with the date and time based on an annotation.
-
-    \param annotation The annotation to process.
-    \param isFirst Indicates if it's the first item in the blame.
-    \return QLabel Returns a newly created QLabel.
-   */
-   QLabel *createDateLabel(const Annotation &annotation, bool isFirst);
-   /*!
-    \brief Factory method that creates a label with the author information based on an annotation.
-
-    \param author The author to be shown.
-    \param isFirst Indicates if it's the first item in the blame.
-    \return QLabel Returns a newly created QLabel.
-   */
-   QLabel *createAuthorLabel(const QString &author, bool isFirst);
-   /*!
-    \brief Factory method that creates a Clickable frame with the information of the commit (SHA and title).
-
-    \param sha The sha to show.
-    \param isFirst Indicates if it's the first item in the blame.
-    \return Returns a newly created ButtonLink.
-   */
-   ButtonLink *createMessageLabel(const QString &sha, bool isFirst);
-   /*!
-    \brief Factory method that creates a label with the number of line. Uses the \p annotation parameter to display a
-    visual help about when the change was done.
-
-    \param annotation The annotation to process.
-    \param row The row to display.
-    \return QLabel Returns a newly created QLabel.
-   */
-   QLabel *createNumLabel(const Annotation &annotation, int row);
-   /*!
-    \brief Factory method that creates a label with the code line to be displayed.
-
-    \param content The code line to display.
-    \return QLabel Returns a newly created QLable.
-   */
-   QLabel *createCodeLabel(const QString &content);
+   bool mContentLoaded = false;
+   bool mBlameFinished = false;
+
+   QProcess *createGitProcess();
+   void showContent(const QByteArray &content);
+   void processContentFailed();
+   void processBlameOutput();
+   void processBlameFinished(bool success);
+   void updateAnnotations();
 };
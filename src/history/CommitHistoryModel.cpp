@@ -1,13 +1,15 @@
 #include "CommitHistoryModel.h"
 
 #include <CommitHistoryColumns.h>
-#include <CommitInfo.h>
+#include <CommitTable.h>
 #include <GitBase.h>
 #include <GitCache.h>
 
 #include <QDateTime>
 #include <QLocale>
 
+#include <algorithm>
+
 CommitHistoryModel::CommitHistoryModel(const QSharedPointer<GitCache> &cache, const QSharedPointer<GitBase> &git,
                                        QObject *p)
    : QAbstractItemModel(p)
@@ -24,7 +26,7 @@ CommitHistoryModel::CommitHistoryModel(const QSharedPointer<GitCache> &cache, co
 
 int CommitHistoryModel::rowCount(const QModelIndex &parent) const
 {
-   return !parent.isValid() ? mCache->commitCount() : 0;
+   return !parent.isValid() ? mTotalCommits : 0;
 }
 
 bool CommitHistoryModel::hasChildren(const QModelIndex &parent) const
@@ -40,6 +42,7 @@ QString CommitHistoryModel::sha(int row) const
 void CommitHistoryModel::clear()
 {
    beginResetModel();
+   mTotalCommits = 0;
    endResetModel();
    emit headerDataChanged(Qt::Horizontal, 0, 5);
 }
@@ -47,12 +50,70 @@ void CommitHistoryModel::clear()
 void CommitHistoryModel::onNewRevisions(int totalCommits)
 {
    beginResetModel();
+   mTotalCommits = totalCommits;
    endResetModel();
+}
 
-   beginInsertRows(QModelIndex(), 0, totalCommits - 2);
+void CommitHistoryModel::onRevisionsAppended(int totalCommits)
+{
+   if (totalCommits <= mTotalCommits)
+      return;
+
+   beginInsertRows(QModelIndex(), mTotalCommits, totalCommits - 1);
+   mTotalCommits = totalCommits;
    endInsertRows();
 }
 
+void CommitHistoryModel::onRevisionsInserted(int firstRow, int count)
+{
+   if (count > 0)
+   {
+      beginInsertRows(QModelIndex(), firstRow, firstRow + count - 1);
+      mTotalCommits += count;
+      endInsertRows();
+   }
+
+   if (mTotalCommits == 0)
+      return;
+
+   // The WIP changed its parent, and only the lanes of the rows below the new ones might have changed.
+   emit dataChanged(index(0, 0), index(0, mColumns.count() - 1));
+
+   if (firstRow + count < mTotalCommits)
+   {
+      const auto graph = static_cast<int>(CommitHistoryColumns::Graph);
+      emit dataChanged(index(firstRow + count, graph), index(mTotalCommits - 1, graph));
+   }
+}
+
+void CommitHistoryModel::onMetadataLoaded(int firstRow, int lastRow)
+{
+   lastRow = std::min(lastRow, mTotalCommits - 1);
+
+   if (firstRow >= 0 && firstRow <= lastRow)
+      emit dataChanged(index(firstRow, 0), index(lastRow, mColumns.count() - 1));
+}
+
+void CommitHistoryModel::setMoreRevisions(bool moreRevisions)
+{
+   mMoreRevisions = moreRevisions;
+   mFetchingMore = false;
+}
+
+bool CommitHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+   return !parent.isValid() && mMoreRevisions && !mFetchingMore;
+}
+
+void CommitHistoryModel::fetchMore(const QModelIndex &parent)
+{
+   if (canFetchMore(parent))
+   {
+      mFetchingMore = true;
+      emit signalFetchMore();
+   }
+}
+
 QVariant CommitHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
    if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
@@ -63,7 +124,7 @@ QVariant CommitHistoryModel::headerData(int section, Qt::Orientation orientation
 
 QModelIndex CommitHistoryModel::index(int row, int column, const QModelIndex &) const
 {
-   return row >= 0 && row < mCache->commitCount() ? createIndex(row, column, nullptr) : QModelIndex();
+   return row >= 0 && row < mTotalCommits ? createIndex(row, column, nullptr) : QModelIndex();
 }
 
 QModelIndex CommitHistoryModel::parent(const QModelIndex &) const
@@ -71,10 +132,10 @@ QModelIndex CommitHistoryModel::parent(const QModelIndex &) const
    return QModelIndex();
 }
 
-QVariant CommitHistoryModel::getToolTipData(const CommitInfo &r) const
+QVariant CommitHistoryModel::getToolTipData(const CommitRow &r) const
 {
    QString auxMessage;
-   const auto sha = r.sha;
+   const auto sha = r.sha();
 
    if (mGit->getCurrentBranch().isEmpty())
       auxMessage.append(tr("<p>Status: <b>detached</b></p>"));
@@ -95,37 +156,41 @@ QVariant CommitHistoryModel::getToolTipData(const CommitInfo &r) const
       auxMessage.append(tr("<p><b>Tags: </b>%1</p>").arg(tags.join(",")));
 
    QDateTime d;
-   d.setSecsSinceEpoch(r.dateSinceEpoch.count());
+   d.setSecsSinceEpoch(r.dateSinceEpoch().count());
 
    QLocale locale;
 
    return sha == ZERO_SHA
        ? QString()
        : QString("<p>%1 - %2</p><p>%3</p>%4%5")
-             .arg(r.author.split("<").first(), d.toString(locale.dateTimeFormat(QLocale::ShortFormat)), sha,
+             .arg(r.author().split("<").first(), d.toString(locale.dateTimeFormat(QLocale::ShortFormat)), sha,
                   !auxMessage.isEmpty() ? QString("<p>%1</p>").arg(auxMessage) : "",
                   r.isSigned()
                       ? tr("<p> GPG key (%1): %2</p>")
-                            .arg(QString::fromUtf8(r.verifiedSignature() ? "verified" : "not verified"), r.gpgKey)
+                            .arg(QString::fromUtf8(r.verifiedSignature() ? "verified" : "not verified"), r.gpgKey())
                       : "");
 }
 
-QVariant CommitHistoryModel::getDisplayData(const CommitInfo &rev, int column) const
+QVariant CommitHistoryModel::getDisplayData(const CommitRow &rev, int column) const
 {
    switch (static_cast<CommitHistoryColumns>(column))
    {
       case CommitHistoryColumns::Sha: {
-         const auto sha = rev.sha;
+         const auto sha = rev.sha();
          return sha;
       }
       case CommitHistoryColumns::Log:
-         return rev.shortLog;
+         return rev.hasMetadata() ? rev.shortLog() : tr("Loading...");
       case CommitHistoryColumns::Author: {
-         const auto author = rev.author.split("<").first();
+         const auto author = rev.hasMetadata() ? rev.author().split("<").first() : QString("...");
          return author;
       }
       case CommitHistoryColumns::Date: {
-         return QDateTime::fromSecsSinceEpoch(rev.dateSinceEpoch.count()).toString("dd MMM yyyy hh:mm");
+         // The commit-graph only has the commit dates: the author date is known once the commit is read.
+         if (!rev.hasMetadata())
+            return QString("...");
+
+         return QDateTime::fromSecsSinceEpoch(rev.dateSinceEpoch().count()).toString("dd MMM yyyy hh:mm");
       }
       default:
          return QVariant();
@@ -137,7 +202,15 @@ QVariant CommitHistoryModel::data(const QModelIndex &index, int role) const
    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::ToolTipRole))
       return QVariant();
 
-   const auto r = mCache->commitInfo(index.row());
+   const auto commits = mCache->snapshot();
+   const CommitRow r(*commits, index.row());
+
+   if (!r.isValid())
+      return QVariant();
+
+   // The rows loaded with only their topology show a placeholder until the cache has read the rest of the commit.
+   if (!r.hasMetadata())
+      mCache->requestMetadata(index.row());
 
    if (role == Qt::ToolTipRole)
       return getToolTipData(r);
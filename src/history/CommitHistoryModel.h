@@ -28,7 +28,7 @@
 
 class GitCache;
 class GitBase;
-class CommitInfo;
+class CommitRow;
 enum class CommitHistoryColumns;
 
 /**
@@ -40,6 +40,13 @@ enum class CommitHistoryColumns;
 class CommitHistoryModel : public QAbstractItemModel
 {
    Q_OBJECT
+
+signals:
+   /**
+    * @brief Signal triggered when the view reaches the last row and the next page of revisions has to be loaded.
+    */
+   void signalFetchMore();
+
 public:
    /**
     * @brief The default constructor.
@@ -124,6 +131,48 @@ public:
     * @param totalCommits The total of new revisions.
     */
    void onNewRevisions(int totalCommits);
+   /**
+    * @brief Inserts the rows of the revisions that were appended to the cache since the last update. Used while the
+    * history is being loaded so the view can show the revisions as they arrive.
+    *
+    * @param totalCommits The new total of revisions in the cache.
+    */
+   void onRevisionsAppended(int totalCommits);
+   /**
+    * @brief Inserts the rows of the revisions that were added in the middle of the cache by an incremental refresh. The
+    * rest of the rows keep their identity so the selection and the scroll position are kept.
+    *
+    * @param firstRow The first row that was inserted.
+    * @param count The number of rows inserted.
+    */
+   void onRevisionsInserted(int firstRow, int count);
+   /**
+    * @brief Notifies the views that the author, committer and message of some revisions loaded without them are
+    * available.
+    *
+    * @param firstRow The first row updated.
+    * @param lastRow The last row updated.
+    */
+   void onMetadataLoaded(int firstRow, int lastRow);
+   /**
+    * @brief Sets if the history has more revisions to load after the last row.
+    *
+    * @param moreRevisions Whether there are more revisions to load.
+    */
+   void setMoreRevisions(bool moreRevisions);
+   /**
+    * @brief Returns if more revisions can be loaded after the last row.
+    *
+    * @param parent The parent index.
+    * @return bool True if there are more revisions and they are not being loaded already.
+    */
+   bool canFetchMore(const QModelIndex &parent) const override;
+   /**
+    * @brief Requests the next page of revisions. The rows are added when the page is loaded.
+    *
+    * @param parent The parent index.
+    */
+   void fetchMore(const QModelIndex &parent) override;
    /*!
     * \brief Gets the number of columns in the model.
     * \return The number of columns.
@@ -134,6 +183,9 @@ private:
    QSharedPointer<GitCache> mCache;
    QSharedPointer<GitBase> mGit;
    QMap<CommitHistoryColumns, QString> mColumns;
+   int mTotalCommits = 0;
+   bool mMoreRevisions = false;
+   bool mFetchingMore = false;
 
    /**
     * @brief Returns the tool tip data.
@@ -141,7 +193,7 @@ private:
     * @param r The commit to generate the tooltip data.
     * @return QVariant The tool tip data.
     */
-   QVariant getToolTipData(const CommitInfo &r) const;
+   QVariant getToolTipData(const CommitRow &r) const;
    /**
     * @brief Returns the data that will be display for every \p column.
     *
@@ -149,5 +201,5 @@ private:
     * @param column The column where the data will be shown.
     * @return QVariant The data to be shown.
     */
-   QVariant getDisplayData(const CommitInfo &rev, int column) const;
+   QVariant getDisplayData(const CommitRow &rev, int column) const;
 };
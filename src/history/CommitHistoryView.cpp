@@ -68,14 +68,10 @@ void CommitHistoryView::filterBySha(const QStringList &shaList)
    mIsFiltering = true;
 
    if (mProxyModel)
-   {
-      mProxyModel->beginResetModel();
       mProxyModel->setAcceptedSha(shaList);
-      mProxyModel->endResetModel();
-   }
    else
    {
-      mProxyModel = new ShaFilterProxyModel(this);
+      mProxyModel = new ShaFilterProxyModel(mCache, this);
       mProxyModel->setSourceModel(mCommitHistoryModel);
       mProxyModel->setAcceptedSha(shaList);
       setModel(mProxyModel);
@@ -84,6 +80,30 @@ void CommitHistoryView::filterBySha(const QStringList &shaList)
    setupGeometry();
 }
 
+void CommitHistoryView::addToFilter(const QStringList &shaList)
+{
+   if (!mProxyModel)
+      filterBySha(shaList);
+   else
+   {
+      mIsFiltering = true;
+      mProxyModel->addAcceptedSha(shaList);
+   }
+}
+
+void CommitHistoryView::clearFilter()
+{
+   if (!mProxyModel)
+      return;
+
+   mIsFiltering = false;
+
+   setModel(mProxyModel->sourceModel());
+
+   mProxyModel->deleteLater();
+   mProxyModel = nullptr;
+}
+
 CommitHistoryView::~CommitHistoryView()
 {
    mSettings->setLocalValue(QString("%1").arg(objectName()), header()->saveState());
@@ -172,7 +192,7 @@ void CommitHistoryView::focusOnCommit(const QString &goToSha)
 
    QLog_Info("UI", QString("Setting the focus on the commit {%1}").arg(mCurrentSha));
 
-   auto row = mCache->commitInfo(mCurrentSha).pos;
+   auto row = std::max(mCache->commitRow(mCurrentSha), 0);
 
    if (mIsFiltering)
    {
@@ -132,6 +132,16 @@ public:
     * @param shaList List of SHA to pass to the filter.
     */
    void filterBySha(const QStringList &shaList);
+   /**
+    * @brief Adds SHAs to the ones shown by the filter. The filter is activated if it wasn't.
+    *
+    * @param shaList List of SHA to add to the filter.
+    */
+   void addToFilter(const QStringList &shaList);
+   /**
+    * @brief Removes the filter and shows all the commits again.
+    */
+   void clearFilter();
    /**
     * @brief Activates/deactivates filtering in the view.
     *
@@ -0,0 +1,152 @@
+#include "ContentSearch.h"
+
+#include <GitBase.h>
+
+#include <QLogger.h>
+
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTimer>
+
+#include <utility>
+
+using namespace QLogger;
+
+namespace
+{
+const int BATCH_INTERVAL_MS = 250;
+}
+
+ContentSearch::ContentSearch(const QSharedPointer<GitBase> &git, QObject *parent)
+   : QObject(parent)
+   , mGit(git)
+   , mBatchTimer(new QTimer(this))
+{
+   mBatchTimer->setSingleShot(true);
+   mBatchTimer->setInterval(BATCH_INTERVAL_MS);
+
+   connect(mBatchTimer, &QTimer::timeout, this, &ContentSearch::flush);
+}
+
+ContentSearch::~ContentSearch()
+{
+   cancel();
+}
+
+void ContentSearch::start(const QString &text, bool allBranches)
+{
+   cancel();
+
+   if (text.isEmpty())
+      return;
+
+   const auto isRegExp = text.size() > 2 && text.startsWith("/") && text.endsWith("/");
+   QStringList args { "log", "--format=%H" };
+   args.append(isRegExp ? QString("-G%1").arg(text.mid(1, text.size() - 2)) : QString("-S%1").arg(text));
+
+   if (allBranches)
+      args.append("--all");
+
+   QLog_Info("Git", QString("Searching the changes that contain {%1}.").arg(text));
+
+   // Without it git buffers the output of the pipe and the first commits found would wait for the next ones.
+   auto environment = QProcessEnvironment::systemEnvironment();
+   environment.insert("GIT_FLUSH", "1");
+
+   mProcess = new QProcess(this);
+   mProcess->setWorkingDirectory(mGit->getWorkingDir());
+   mProcess->setProcessEnvironment(environment);
+
+   connect(mProcess, &QProcess::readyReadStandardOutput, this, &ContentSearch::processOutput);
+   connect(mProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+           &ContentSearch::processFinished);
+   connect(mProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+      if (error == QProcess::FailedToStart)
+      {
+         QLog_Error("Git", QString("Git couldn't be started to search the changes: %1").arg(mProcess->errorString()));
+
+         mProcess->deleteLater();
+         mProcess = nullptr;
+
+         emit finished(false);
+      }
+   });
+
+   mProcess->start("git", args);
+}
+
+void ContentSearch::cancel()
+{
+   mBatchTimer->stop();
+   mBuffer.clear();
+   mPending.clear();
+   mFound = 0;
+
+   if (mProcess)
+   {
+      QLog_Debug("Git", "Cancelling the search in the changes.");
+
+      mProcess->disconnect(this);
+      mProcess->kill();
+      mProcess->deleteLater();
+      mProcess = nullptr;
+   }
+}
+
+void ContentSearch::processOutput()
+{
+   mBuffer.append(mProcess->readAllStandardOutput());
+
+   const auto lastLineEnd = mBuffer.lastIndexOf('\n');
+
+   if (lastLineEnd == -1)
+      return;
+
+   for (const auto &line : mBuffer.left(lastLineEnd).split('\n'))
+   {
+      if (const auto sha = line.trimmed(); !sha.isEmpty())
+         mPending.append(QString::fromLatin1(sha));
+   }
+
+   mBuffer.remove(0, lastLineEnd + 1);
+
+   // The first commits are shown right away, the next ones in batches so the view isn't filtered on every line.
+   if (mFound == 0)
+      flush();
+   else if (!mBatchTimer->isActive())
+      mBatchTimer->start();
+}
+
+void ContentSearch::processFinished(int exitCode)
+{
+   processOutput();
+   flush();
+
+   const auto success = exitCode == 0;
+
+   if (success)
+      QLog_Info("Git", QString("The search in the changes found {%1} commits.").arg(mFound));
+   else
+   {
+      const auto error = QString::fromUtf8(mProcess->readAllStandardError());
+
+      QLog_Warning("Git", QString("The search in the changes failed: %1").arg(error));
+   }
+
+   mProcess->deleteLater();
+   mProcess = nullptr;
+
+   emit finished(success);
+}
+
+void ContentSearch::flush()
+{
+   mBatchTimer->stop();
+
+   if (mPending.isEmpty())
+      return;
+
+   mFound += static_cast<int>(mPending.count());
+
+   emit shasFound(std::exchange(mPending, QStringList()));
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+
+class GitBase;
+class QProcess;
+class QTimer;
+
+/**
+ * @brief The ContentSearch class looks for the commits whose changes add or remove a text (git log -S), or whose diff
+ * matches a regular expression (git log -G) when the text is written between slashes. The search runs in a background
+ * git process and the SHAs are reported in batches while git finds them, so the first results can be shown long before
+ * the whole history is scanned.
+ */
+class ContentSearch : public QObject
+{
+   Q_OBJECT
+
+signals:
+   /**
+    * @brief Emitted with the commits found since the previous batch, in the order git reports them.
+    */
+   void shasFound(const QStringList &shas);
+   /**
+    * @brief Emitted when git finishes the search. It's not emitted when the search is cancelled.
+    *
+    * @param success True if git finished without errors.
+    */
+   void finished(bool success);
+
+public:
+   explicit ContentSearch(const QSharedPointer<GitBase> &git, QObject *parent = nullptr);
+   ~ContentSearch() override;
+
+   /**
+    * @brief Starts a new search, cancelling the one in progress.
+    *
+    * @param text The text to look for in the changes, or a regular expression between slashes.
+    * @param allBranches True to search in all the branches, false to only search in the current one.
+    */
+   void start(const QString &text, bool allBranches);
+   void cancel();
+   bool isRunning() const { return mProcess != nullptr; }
+   int found() const { return mFound; }
+
+private:
+   QSharedPointer<GitBase> mGit;
+   QProcess *mProcess = nullptr;
+   QTimer *mBatchTimer = nullptr;
+   QByteArray mBuffer;
+   QStringList mPending;
+   int mFound = 0;
+
+   void processOutput();
+   void processFinished(int exitCode);
+   void flush();
+};
@@ -0,0 +1,197 @@
+#include "FileHistoryLoader.h"
+
+#include <CommitTable.h>
+#include <GitBase.h>
+#include <GitCache.h>
+#include <GitExecResult.h>
+
+#include <QLogger.h>
+
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTimer>
+
+using namespace QLogger;
+
+namespace
+{
+const int BATCH_INTERVAL_MS = 250;
+const int FIRST_BATCH_SIZE = 2; // The blame needs the last commit of the file and the previous one.
+}
+
+FileHistoryLoader::FileHistoryLoader(const QSharedPointer<GitCache> &cache, const QSharedPointer<GitBase> &git,
+                                     QObject *parent)
+   : QObject(parent)
+   , mCache(cache)
+   , mGit(git)
+   , mBatchTimer(new QTimer(this))
+{
+   mBatchTimer->setSingleShot(true);
+   mBatchTimer->setInterval(BATCH_INTERVAL_MS);
+
+   connect(mBatchTimer, &QTimer::timeout, this, &FileHistoryLoader::flush);
+}
+
+FileHistoryLoader::~FileHistoryLoader()
+{
+   cancel();
+}
+
+bool FileHistoryLoader::history(const QString &file, QStringList *shas) const
+{
+   const auto iter = mHistories.constFind(file);
+
+   if (iter == mHistories.constEnd() || iter->head != currentHead())
+      return false;
+
+   *shas = iter->shas;
+
+   return true;
+}
+
+void FileHistoryLoader::load(const QString &file)
+{
+   cancel();
+
+   mFile = file;
+   mHead = currentHead();
+
+   QLog_Debug("Git", QString("Loading the history of the file {%1}.").arg(file));
+
+   // The signatures are not needed and, with log.showSignature set, gpg would write its output between the SHAs.
+   const QStringList args { "log", "--follow", "--no-show-signature", "--format=%H", "--", file };
+
+   // Without it git buffers the output of the pipe and the last commits would wait for the whole history.
+   auto environment = QProcessEnvironment::systemEnvironment();
+   environment.insert("GIT_FLUSH", "1");
+
+   mProcess = new QProcess(this);
+   mProcess->setWorkingDirectory(mGit->getWorkingDir());
+   mProcess->setProcessEnvironment(environment);
+
+   connect(mProcess, &QProcess::readyReadStandardOutput, this, &FileHistoryLoader::processOutput);
+   connect(mProcess, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this,
+           &FileHistoryLoader::processFinished);
+   connect(mProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+      if (error == QProcess::FailedToStart)
+      {
+         QLog_Error("Git",
+                    QString("Git couldn't be started to load the file history: %1").arg(mProcess->errorString()));
+
+         mProcess->deleteLater();
+         mProcess = nullptr;
+
+         emit finished(mFile, false);
+      }
+   });
+
+   mProcess->start("git", args);
+}
+
+void FileHistoryLoader::cancel()
+{
+   mBatchTimer->stop();
+   mBuffer.clear();
+   mLoaded.clear();
+   mFlushed = 0;
+
+   if (mProcess)
+   {
+      QLog_Debug("Git", QString("Cancelling the load of the history of the file {%1}.").arg(mFile));
+
+      mProcess->disconnect(this);
+      mProcess->kill();
+      mProcess->deleteLater();
+      mProcess = nullptr;
+   }
+}
+
+void FileHistoryLoader::invalidate()
+{
+   const auto head = currentHead();
+
+   for (auto iter = mHistories.begin(); iter != mHistories.end();)
+   {
+      if (iter->head != head)
+         iter = mHistories.erase(iter);
+      else
+         ++iter;
+   }
+}
+
+QString FileHistoryLoader::currentHead() const
+{
+   // The WIP commit is always on top of HEAD.
+   const auto commits = mCache->snapshot();
+   const auto wipRow = commits->row(ZERO_SHA);
+
+   return wipRow != -1 ? commits->firstParent(wipRow) : QString();
+}
+
+void FileHistoryLoader::processOutput()
+{
+   mBuffer.append(mProcess->readAllStandardOutput());
+
+   const auto lastLineEnd = mBuffer.lastIndexOf('\n');
+
+   if (lastLineEnd == -1)
+      return;
+
+   for (const auto &line : mBuffer.left(lastLineEnd).split('\n'))
+   {
+      if (const auto sha = line.trimmed(); !sha.isEmpty() && !sha.startsWith("gpg:"))
+         mLoaded.append(QString::fromLatin1(sha));
+   }
+
+   mBuffer.remove(0, lastLineEnd + 1);
+
+   // The first batch waits for the previous commit of the file, or for the end of the process if there is none.
+   if (mLoaded.count() < FIRST_BATCH_SIZE)
+      return;
+
+   if (mFlushed == 0)
+      flush();
+   else if (!mBatchTimer->isActive())
+      mBatchTimer->start();
+}
+
+void FileHistoryLoader::processFinished(int exitCode)
+{
+   processOutput();
+   flush();
+
+   const auto success = exitCode == 0;
+
+   if (success)
+   {
+      QLog_Debug("Git", QString("The file {%1} was modified in {%2} commits.").arg(mFile).arg(mLoaded.count()));
+
+      mHistories.insert(mFile, { mHead, mLoaded });
+   }
+   else
+   {
+      const auto error = QString::fromUtf8(mProcess->readAllStandardError());
+
+      QLog_Warning("Git", QString("The history of the file {%1} couldn't be loaded: %2").arg(mFile, error));
+   }
+
+   mProcess->deleteLater();
+   mProcess = nullptr;
+   mLoaded.clear();
+   mFlushed = 0;
+
+   emit finished(mFile, success);
+}
+
+void FileHistoryLoader::flush()
+{
+   mBatchTimer->stop();
+
+   if (mFlushed == mLoaded.count())
+      return;
+
+   const auto shas = mLoaded.mid(mFlushed);
+   mFlushed = static_cast<int>(mLoaded.count());
+
+   emit shasFound(mFile, shas);
+}
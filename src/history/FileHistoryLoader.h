@@ -0,0 +1,114 @@
+#pragma once
+
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+
+#include <QHash>
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+
+class GitBase;
+class GitCache;
+class QProcess;
+class QTimer;
+
+/**
+ * @brief The FileHistoryLoader class loads the commits that modified a file (git log --follow) in a background git
+ * process, so opening or switching the blame of a file never blocks the UI. The SHAs are reported in batches while git
+ * finds them: the first batch is sent as soon as the two most recent commits are known.
+ *
+ * The complete histories are cached by file and by the HEAD they were loaded for. When HEAD moves, the history of a
+ * file is loaded again the next time it's requested, and @ref invalidate drops the histories of the previous HEADs.
+ */
+class FileHistoryLoader : public QObject
+{
+   Q_OBJECT
+
+signals:
+   /**
+    * @brief Emitted with the commits found since the previous batch, from the newest to the oldest.
+    *
+    * @param file The file whose history is being loaded.
+    * @param shas The SHAs of the commits.
+    */
+   void shasFound(const QString &file, const QStringList &shas);
+   /**
+    * @brief Emitted when the history of the file is completely loaded. It's not emitted when the load is cancelled.
+    *
+    * @param file The file whose history was loaded.
+    * @param success True if git finished without errors.
+    */
+   void finished(const QString &file, bool success);
+
+public:
+   explicit FileHistoryLoader(const QSharedPointer<GitCache> &cache, const QSharedPointer<GitBase> &git,
+                              QObject *parent = nullptr);
+   ~FileHistoryLoader() override;
+
+   /**
+    * @brief Returns the history of the file if it was already loaded for the current HEAD.
+    *
+    * @param file The file path.
+    * @param shas Filled with the SHAs of the commits, from the newest to the oldest.
+    * @return True if the history is cached.
+    */
+   bool history(const QString &file, QStringList *shas) const;
+   /**
+    * @brief Starts loading the history of a file, cancelling the load in progress.
+    *
+    * @param file The file path.
+    */
+   void load(const QString &file);
+   void cancel();
+   bool isLoading() const { return mProcess != nullptr; }
+   QString file() const { return mFile; }
+   /**
+    * @brief Drops the histories that were loaded for a different HEAD than the current one.
+    */
+   void invalidate();
+
+private:
+   struct History
+   {
+      QString head;
+      QStringList shas;
+   };
+
+   QSharedPointer<GitCache> mCache;
+   QSharedPointer<GitBase> mGit;
+   QProcess *mProcess = nullptr;
+   QTimer *mBatchTimer = nullptr;
+   QString mFile;
+   QString mHead;
+   QByteArray mBuffer;
+   QStringList mLoaded;
+   int mFlushed = 0;
+   QHash<QString, History> mHistories;
+
+   QString currentHead() const;
+   void processOutput();
+   void processFinished(int exitCode);
+   void flush();
+};
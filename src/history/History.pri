@@ -5,6 +5,8 @@ HEADERS += \
     $$PWD/CommitHistoryContextMenu.h \
     $$PWD/CommitHistoryModel.h \
     $$PWD/CommitHistoryView.h \
+    $$PWD/ContentSearch.h \
+    $$PWD/FileHistoryLoader.h \
     $$PWD/RepositoryViewDelegate.h \
     $$PWD/ShaFilterProxyModel.h
 
@@ -12,5 +14,7 @@ SOURCES += \
     $$PWD/CommitHistoryContextMenu.cpp \
     $$PWD/CommitHistoryModel.cpp \
     $$PWD/CommitHistoryView.cpp \
+    $$PWD/ContentSearch.cpp \
+    $$PWD/FileHistoryLoader.cpp \
     $$PWD/RepositoryViewDelegate.cpp \
     $$PWD/ShaFilterProxyModel.cpp
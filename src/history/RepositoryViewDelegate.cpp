@@ -4,7 +4,7 @@
 #include <CommitHistoryColumns.h>
 #include <CommitHistoryModel.h>
 #include <CommitHistoryView.h>
-#include <CommitInfo.h>
+#include <CommitTable.h>
 #include <GitBase.h>
 #include <GitCache.h>
 #include <GitLocal.h>
@@ -15,6 +15,7 @@
 #include <Lane.h>
 #include <LaneType.h>
 
+#include <QAbstractProxyModel>
 #include <QApplication>
 #include <QClipboard>
 #include <QDesktopServices>
@@ -22,13 +23,18 @@
 #include <QHeaderView>
 #include <QPainter>
 #include <QPainterPath>
-#include <QSortFilterProxyModel>
 #include <QToolTip>
 #include <QUrl>
 #include <QFontDatabase>
 
 using namespace GitServerPlugin;
 
+namespace
+{
+// A few screens of rows: scrolling back and forth doesn't decode their subjects again.
+const int SUBJECT_CACHE_ROWS = 2000;
+}
+
 RepositoryViewDelegate::RepositoryViewDelegate(const QSharedPointer<GitCache> &cache,
                                                const QSharedPointer<GitBase> &git,
                                                const QSharedPointer<IGitServerCache> &gitServerCache,
@@ -38,17 +44,20 @@ RepositoryViewDelegate::RepositoryViewDelegate(const QSharedPointer<GitCache> &c
    , mGitServerCache(gitServerCache)
    , mView(view)
 {
+   mSubjects.setMaxCost(SUBJECT_CACHE_ROWS);
 }
 
 void RepositoryViewDelegate::paint(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &index) const
 {
    const auto row = mView->hasActiveFilter()
-       ? dynamic_cast<QSortFilterProxyModel *>(mView->model())->mapToSource(index).row()
+       ? dynamic_cast<QAbstractProxyModel *>(mView->model())->mapToSource(index).row()
        : index.row();
 
-   const auto commit = mCache->commitInfo(row);
+   // The snapshot keeps the commit alive while it's painted, even if the loader publishes a new one meanwhile.
+   const auto commits = mCache->snapshot();
+   const CommitRow commit(*commits, row);
 
-   if (commit.sha.isEmpty())
+   if (!commit.isValid())
       return;
 
    p->setRenderHints(QPainter::Antialiasing);
@@ -66,7 +75,7 @@ void RepositoryViewDelegate::paint(QPainter *p, const QStyleOptionViewItem &opt,
       p->fillRect(newOpt.rect, nonGraphColumnBkgColor);
 
       if (index.column() == static_cast<int>(CommitHistoryColumns::Graph)
-          && (mView->hasActiveFilter() || commit.sha != ZERO_SHA))
+          && (mView->hasActiveFilter() || !commit.isWip()))
       {
          auto color = GitQlientStyles::getBranchColorAt(
              mView->hasActiveFilter() ? 0 : commit.getActiveLane() % GitQlientStyles::getTotalBranchColors());
@@ -124,7 +133,7 @@ void RepositoryViewDelegate::paint(QPainter *p, const QStyleOptionViewItem &opt,
             newOpt.font.setPointSize(defaultFontSize - 2);
             newOpt.font.setFamily("DejaVu Sans Mono");
 
-            text = commit.sha != ZERO_SHA ? text.left(8) : "";
+            text = !commit.isWip() ? text.left(8) : "";
          }
          else if (index.column() == static_cast<int>(CommitHistoryColumns::Author) && commit.isSigned())
          {
@@ -188,10 +197,10 @@ bool RepositoryViewDelegate::editorEvent(QEvent *event, QAbstractItemModel *mode
 }
 
 QColor RepositoryViewDelegate::paintBranchHelper(QPainter *p, const QStyleOptionViewItem &opt,
-                                                 const CommitInfo &commit) const
+                                                 const CommitRow &commit) const
 {
    const auto colorIndex = mView->hasActiveFilter() ? 0
-       : commit.sha != ZERO_SHA                     ? commit.getActiveLane() % GitQlientStyles::getTotalBranchColors()
+       : !commit.isWip()                            ? commit.getActiveLane() % GitQlientStyles::getTotalBranchColors()
                                                     : -1;
 
    if (colorIndex != -1)
@@ -375,7 +384,7 @@ void RepositoryViewDelegate::paintGraphLane(QPainter *p, const Lane &lane, bool
    }
 }
 
-QColor RepositoryViewDelegate::getMergeColor(const Lane &currentLane, const CommitInfo &commit, int currentLaneIndex,
+QColor RepositoryViewDelegate::getMergeColor(const Lane &currentLane, const LaneRow &lanes, int currentLaneIndex,
                                              const QColor &defaultColor, bool &isSet) const
 {
    auto mergeColor = defaultColor;
@@ -396,7 +405,7 @@ QColor RepositoryViewDelegate::getMergeColor(const Lane &currentLane, const Comm
       case LaneType::JOIN_L:
          for (auto laneCount = 0; laneCount < currentLaneIndex; ++laneCount)
          {
-            if (commit.laneAt(laneCount).equals(LaneType::JOIN_L))
+            if (lanes.at(laneCount).equals(LaneType::JOIN_L))
             {
                mergeColor = GitQlientStyles::getBranchColorAt(laneCount % GitQlientStyles::getTotalBranchColors());
                isSet = true;
@@ -411,7 +420,7 @@ QColor RepositoryViewDelegate::getMergeColor(const Lane &currentLane, const Comm
    return mergeColor;
 }
 
-void RepositoryViewDelegate::paintGraph(QPainter *p, const QStyleOptionViewItem &opt, const CommitInfo &commit) const
+void RepositoryViewDelegate::paintGraph(QPainter *p, const QStyleOptionViewItem &opt, const CommitRow &commit) const
 {
    p->save();
    p->setClipRect(opt.rect, Qt::IntersectClip);
@@ -425,7 +434,7 @@ void RepositoryViewDelegate::paintGraph(QPainter *p, const QStyleOptionViewItem
    }
    else
    {
-      if (commit.sha == ZERO_SHA)
+      if (commit.isWip())
       {
          const auto activeColor = GitQlientStyles::getBranchColorAt(0);
          QColor color = activeColor;
@@ -438,8 +447,10 @@ void RepositoryViewDelegate::paintGraph(QPainter *p, const QStyleOptionViewItem
       }
       else
       {
-         const auto laneNum = commit.lanesCount();
-         const auto activeLane = commit.getActiveLane();
+         const auto &lanes = commit.lanes();
+         const auto laneNum = lanes.count();
+         const auto activeLane = lanes.activeLane();
+         const auto hasChilds = commit.hasChilds();
          const auto activeColor
              = GitQlientStyles::getBranchColorAt(activeLane % GitQlientStyles::getTotalBranchColors());
          auto x1 = 0;
@@ -451,11 +462,11 @@ void RepositoryViewDelegate::paintGraph(QPainter *p, const QStyleOptionViewItem
          {
             x1 = x2 - LANE_WIDTH;
 
-            auto currentLane = commit.laneAt(i);
+            const auto currentLane = lanes.at(i);
 
             if (!laneHeadPresent && i < laneNum - 1)
             {
-               auto prevLane = commit.laneAt(i + 1);
+               const auto prevLane = lanes.at(i + 1);
                laneHeadPresent
                    = prevLane.isHead() || prevLane.equals(LaneType::JOIN_R) || prevLane.equals(LaneType::JOIN_L);
             }
@@ -468,10 +479,10 @@ void RepositoryViewDelegate::paintGraph(QPainter *p, const QStyleOptionViewItem
                   color = GitQlientStyles::getBranchColorAt(i % GitQlientStyles::getTotalBranchColors());
 
                if (!isSet)
-                  mergeColor = getMergeColor(currentLane, commit, i, color, isSet);
+                  mergeColor = getMergeColor(currentLane, lanes, i, color, isSet);
 
                paintGraphLane(p, currentLane, laneHeadPresent, x1, x2, color, activeColor, mergeColor, false,
-                              commit.hasChilds());
+                              hasChilds);
 
                if (mView->hasActiveFilter())
                   break;
@@ -483,16 +494,16 @@ void RepositoryViewDelegate::paintGraph(QPainter *p, const QStyleOptionViewItem
 }
 
 void RepositoryViewDelegate::paintLog(QPainter *p, const QStyleOptionViewItem &opt, const QColor &currentLangeColor,
-                                      const CommitInfo &commit) const
+                                      const CommitRow &commit) const
 {
-   if (commit.sha.isEmpty())
+   if (!commit.isValid())
       return;
 
    auto offset = 5;
 
    if (mGitServerCache)
    {
-      if (const auto pr = mGitServerCache->getPullRequest(commit.sha); pr.isValid())
+      if (const auto pr = mGitServerCache->getPullRequest(commit.sha()); pr.isValid())
       {
          offset += 5;
          paintPrStatus(p, opt, offset, pr);
@@ -508,15 +519,25 @@ void RepositoryViewDelegate::paintLog(QPainter *p, const QStyleOptionViewItem &o
    QFontMetrics fm(newOpt.font);
 
    p->setFont(newOpt.font);
-   p->setPen(GitQlientStyles::getTextColor());
-   p->drawText(newOpt.rect, fm.elidedText(commit.shortLog, Qt::ElideRight, newOpt.rect.width()),
-               QTextOption(Qt::AlignLeft | Qt::AlignVCenter));
+
+   if (commit.hasMetadata())
+   {
+      p->setPen(GitQlientStyles::getTextColor());
+      p->drawText(newOpt.rect, fm.elidedText(subject(commit), Qt::ElideRight, newOpt.rect.width()),
+                  QTextOption(Qt::AlignLeft | Qt::AlignVCenter));
+   }
+   else
+   {
+      p->setPen(GitQlientStyles::getTextColor().darker(150));
+      p->drawText(newOpt.rect, fm.elidedText(tr("Loading..."), Qt::ElideRight, newOpt.rect.width()),
+                  QTextOption(Qt::AlignLeft | Qt::AlignVCenter));
+   }
 }
 
 void RepositoryViewDelegate::paintTagBranch(QPainter *painter, QStyleOptionViewItem o, const QColor &currentLangeColor,
-                                            int &startPoint, const CommitInfo &commit) const
+                                            int &startPoint, const CommitRow &commit) const
 {
-   if (mCache->hasReferences(commit.sha) && !mView->hasActiveFilter())
+   if (mCache->hasReferences(commit.row()) && !mView->hasActiveFilter())
    {
       struct RefConfig
       {
@@ -527,6 +548,7 @@ void RepositoryViewDelegate::paintTagBranch(QPainter *painter, QStyleOptionViewI
       };
 
       QVector<RefConfig> refs;
+      const auto sha = commit.sha();
       const auto currentBranch = mGit->getCurrentBranch();
 
       if (startPoint <= 5)
@@ -534,7 +556,7 @@ void RepositoryViewDelegate::paintTagBranch(QPainter *painter, QStyleOptionViewI
 
       if ((currentBranch.isEmpty() || currentBranch == "HEAD"))
       {
-         if (const auto ret = mGit->getLastCommit(); ret.success && commit.sha == ret.output.trimmed())
+         if (const auto ret = mGit->getLastCommit(); ret.success && sha == ret.output.trimmed())
          {
             refs.append({ "detached", graphDetached, "" });
          }
@@ -542,19 +564,19 @@ void RepositoryViewDelegate::paintTagBranch(QPainter *painter, QStyleOptionViewI
 
       static const auto suffix
           = QString::fromUtf8(GitQlientSettings().globalValue("colorSchema", 0).toInt() == 1 ? "bright" : "dark");
-      const auto localBranches = mCache->getReferences(commit.sha, References::Type::LocalBranch);
+      const auto localBranches = mCache->getReferences(sha, References::Type::LocalBranch);
       for (const auto &branch : localBranches)
       {
          refs.append({ branch, currentLangeColor, QString(":/icons/branch_indicator_%1").arg(suffix) });
       }
 
-      const auto tags = mCache->getReferences(commit.sha, References::Type::LocalTag);
+      const auto tags = mCache->getReferences(sha, References::Type::LocalTag);
       for (const auto &tag : tags)
       {
          refs.append({ tag, graphTag, QString(":/icons/tag_indicator_%1").arg(suffix), true });
       }
 
-      const auto remoteBranches = mCache->getReferences(commit.sha, References::Type::RemoteBranches);
+      const auto remoteBranches = mCache->getReferences(sha, References::Type::RemoteBranches);
       for (const auto &branch : remoteBranches)
       {
          refs.append({ branch, currentLangeColor, QString(":/icons/branch_indicator_%1").arg(suffix) });
@@ -577,7 +599,7 @@ void RepositoryViewDelegate::paintTagBranch(QPainter *painter, QStyleOptionViewI
           tmpBuffer += 20;
       }
 
-      finalText.append(commit.shortLog);
+      finalText.append(subject(commit));
 
       QString nameToDisplay;
 
@@ -661,3 +683,19 @@ void RepositoryViewDelegate::paintPrStatus(QPainter *painter, QStyleOptionViewIt
 
    startPoint += 10 + 5;
 }
+
+QString RepositoryViewDelegate::subject(const CommitRow &commit) const
+{
+   // The subject of a commit never changes once it's read. The WIP changes it with the local changes.
+   if (commit.isWip() || !commit.hasMetadata())
+      return commit.shortLog();
+
+   if (const auto subject = mSubjects.object(commit.oid()))
+      return *subject;
+
+   const auto subject = commit.shortLog();
+
+   mSubjects.insert(commit.oid(), new QString(subject));
+
+   return subject;
+}
@@ -23,6 +23,9 @@
  ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  ***************************************************************************************/
 
+#include <Oid.h>
+
+#include <QCache>
 #include <QDateTime>
 #include <QStyledItemDelegate>
 
@@ -30,7 +33,8 @@ class CommitHistoryView;
 class GitCache;
 class GitBase;
 class Lane;
-class CommitInfo;
+class CommitRow;
+class LaneRow;
 class IGitServerCache;
 
 namespace GitServerPlugin
@@ -89,6 +93,7 @@ private:
    CommitHistoryView *mView = nullptr;
    int diffTargetRow = -1;
    int mColumnPressed = -1;
+   mutable QCache<Oid, QString> mSubjects;
 
    /**
     * @brief Paints a fine vertical line aimed to help in the visualization of to what branch the commit belongs to.
@@ -96,7 +101,7 @@ private:
     * @param o The style options of the item.
     * @param commit The commit information.
     */
-   [[nodiscard]] QColor paintBranchHelper(QPainter *p, const QStyleOptionViewItem &o, const CommitInfo &commit) const;
+   [[nodiscard]] QColor paintBranchHelper(QPainter *p, const QStyleOptionViewItem &o, const CommitRow &commit) const;
 
    /**
     * @brief Paints the log column. This method is in charge of painting the commit message as well as tags or
@@ -108,7 +113,7 @@ private:
     * @param commit The commit information.
     */
    void paintLog(QPainter *p, const QStyleOptionViewItem &o, const QColor &currentLangeColor,
-                 const CommitInfo &commit) const;
+                 const CommitRow &commit) const;
    /**
     * @brief Method that sets up the configuration to paint the lane for the commit graph representation.
     *
@@ -116,7 +121,7 @@ private:
     * @param o The style options of the item.
     * @param commit The commit information.
     */
-   void paintGraph(QPainter *p, const QStyleOptionViewItem &o, const CommitInfo &commit) const;
+   void paintGraph(QPainter *p, const QStyleOptionViewItem &o, const CommitRow &commit) const;
 
    /**
     * @brief Specialization method called by @ref paintGrapth that does the actual lane painting.
@@ -145,7 +150,7 @@ private:
     * @param commit The SHA reference to paint. It can be local branch, remote branch, tag or it could be detached.
     */
    void paintTagBranch(QPainter *painter, QStyleOptionViewItem opt, const QColor &currentLangeColor, int &startPoint,
-                       const CommitInfo &commit) const;
+                       const CommitRow &commit) const;
 
    /**
     * @brief Specialized method that paints a tag in the commit message column.
@@ -158,17 +163,26 @@ private:
    void paintPrStatus(QPainter *painter, QStyleOptionViewItem opt, int &startPoint,
                       const GitServerPlugin::PullRequest &pr) const;
 
+   /**
+    * @brief Returns the subject of the commit. The subjects of the rows painted are kept decoded, so repainting them
+    * while scrolling doesn't decode them again.
+    *
+    * @param commit The commit whose subject is painted.
+    * @return The subject of the commit.
+    */
+   QString subject(const CommitRow &commit) const;
+
    /**
     * @brief getMergeColor Returns the color to be used for painting the external circle of the node. This methods
     * searches the origin of the merge and uses the same lane color.
     * @param currentLane The current lane type.
-    * @param commit The current commit.
+    * @param lanes The lanes of the current commit.
     * @param currentLaneIndex The current index of the lane.
     * @param defaultColor The default color in case it's not a merge.
     * @param isSet Boolean used as a shortcut. If the current iteration is a merge it will change the value for the
     * following lanes.
     * @return Returns the color of the lane that merges into the current node, otherwise it returns @p defaultColor.
     */
-   QColor getMergeColor(const Lane &currentLane, const CommitInfo &commit, int currentLaneIndex,
+   QColor getMergeColor(const Lane &currentLane, const LaneRow &lanes, int currentLaneIndex,
                         const QColor &defaultColor, bool &isSet) const;
 };
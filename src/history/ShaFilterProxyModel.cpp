@@ -1,15 +1,215 @@
 #include "ShaFilterProxyModel.h"
 
-#include <CommitHistoryColumns.h>
+#include <CommitTable.h>
+#include <GitCache.h>
 
-ShaFilterProxyModel::ShaFilterProxyModel(QObject *parent)
-   : QSortFilterProxyModel(parent)
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+ShaFilterProxyModel::ShaFilterProxyModel(const QSharedPointer<GitCache> &cache, QObject *parent)
+   : QAbstractProxyModel(parent)
+   , mCache(cache)
+{
+}
+
+void ShaFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+   beginResetModel();
+
+   if (const auto previous = this->sourceModel())
+      disconnect(previous, nullptr, this, nullptr);
+
+   QAbstractProxyModel::setSourceModel(sourceModel);
+
+   if (sourceModel)
+   {
+      connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &ShaFilterProxyModel::beginResetModel);
+      connect(sourceModel, &QAbstractItemModel::modelReset, this, &ShaFilterProxyModel::resolveAll);
+      connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &ShaFilterProxyModel::onSourceRowsInserted);
+      // The commits of the removed rows are not known anymore, so all the accepted SHAs are resolved again.
+      connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, [this]() {
+         beginResetModel();
+         resolveAll();
+      });
+      connect(sourceModel, &QAbstractItemModel::dataChanged, this, &ShaFilterProxyModel::onSourceDataChanged);
+   }
+
+   mPendingShas.clear();
+   mRows = resolve(mAcceptedShas.values(), &mPendingShas);
+
+   endResetModel();
+}
+
+void ShaFilterProxyModel::setAcceptedSha(const QStringList &acceptedShaList)
 {
+   beginResetModel();
+
+   mAcceptedShas.clear();
+   mPendingShas.clear();
+
+   for (const auto &sha : acceptedShaList)
+      mAcceptedShas.insert(sha);
+
+   mRows = resolve(acceptedShaList, &mPendingShas);
+
+   endResetModel();
 }
 
-bool ShaFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+void ShaFilterProxyModel::addAcceptedSha(const QStringList &shaList)
 {
-   const auto shaIndex = sourceModel()->index(sourceRow, static_cast<int>(CommitHistoryColumns::Sha), sourceParent);
-   const auto sha = sourceModel()->data(shaIndex).toString();
-   return mAcceptedShas.contains(sha);
+   QStringList newShas;
+
+   for (const auto &sha : shaList)
+   {
+      if (!mAcceptedShas.contains(sha))
+      {
+         mAcceptedShas.insert(sha);
+         newShas.append(sha);
+      }
+   }
+
+   insertSourceRows(resolve(newShas, &mPendingShas));
+}
+
+void ShaFilterProxyModel::insertSourceRows(const QVector<int> &newRows)
+{
+   // The new rows that fall between the same two accepted rows are inserted as a single block.
+   for (auto first = newRows.cbegin(); first != newRows.cend();)
+   {
+      const auto position = static_cast<int>(std::lower_bound(mRows.cbegin(), mRows.cend(), *first) - mRows.cbegin());
+      const auto next = position < mRows.count() ? mRows.at(position) : std::numeric_limits<int>::max();
+      const auto last = std::lower_bound(first, newRows.cend(), next);
+      const auto count = static_cast<int>(last - first);
+
+      beginInsertRows(QModelIndex(), position, position + count - 1);
+      std::copy(first, last, std::inserter(mRows, mRows.begin() + position));
+      endInsertRows();
+
+      first = last;
+   }
+}
+
+QModelIndex ShaFilterProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+   if (!sourceModel() || !proxyIndex.isValid() || proxyIndex.row() >= mRows.count())
+      return QModelIndex();
+
+   return sourceModel()->index(mRows.at(proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex ShaFilterProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+   if (!sourceIndex.isValid())
+      return QModelIndex();
+
+   const auto iter = std::lower_bound(mRows.cbegin(), mRows.cend(), sourceIndex.row());
+
+   if (iter == mRows.cend() || *iter != sourceIndex.row())
+      return QModelIndex();
+
+   return index(static_cast<int>(iter - mRows.cbegin()), sourceIndex.column());
+}
+
+QModelIndex ShaFilterProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+   if (parent.isValid() || row < 0 || row >= mRows.count() || column < 0 || column >= columnCount())
+      return QModelIndex();
+
+   return createIndex(row, column);
+}
+
+QModelIndex ShaFilterProxyModel::parent(const QModelIndex &) const
+{
+   return QModelIndex();
+}
+
+int ShaFilterProxyModel::rowCount(const QModelIndex &parent) const
+{
+   return !parent.isValid() ? static_cast<int>(mRows.count()) : 0;
+}
+
+int ShaFilterProxyModel::columnCount(const QModelIndex &parent) const
+{
+   return sourceModel() && !parent.isValid() ? sourceModel()->columnCount() : 0;
+}
+
+bool ShaFilterProxyModel::hasChildren(const QModelIndex &parent) const
+{
+   return !parent.isValid() && !mRows.isEmpty();
+}
+
+QVector<int> ShaFilterProxyModel::resolve(const QStringList &shaList, QSet<QString> *unresolved) const
+{
+   QVector<int> rows;
+
+   if (!sourceModel())
+   {
+      for (const auto &sha : shaList)
+         unresolved->insert(sha);
+
+      return rows;
+   }
+
+   // The source model can be behind the cache, so the rows it doesn't have yet are left out until it catches up.
+   const auto commits = mCache->snapshot();
+   const auto totalRows = sourceModel()->rowCount();
+
+   rows.reserve(shaList.count());
+
+   for (const auto &sha : shaList)
+   {
+      if (const auto row = commits->row(sha); row != -1 && row < totalRows)
+         rows.append(row);
+      else
+         unresolved->insert(sha);
+   }
+
+   std::sort(rows.begin(), rows.end());
+   rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+   return rows;
+}
+
+void ShaFilterProxyModel::resolveAll()
+{
+   mPendingShas.clear();
+   mRows = resolve(mAcceptedShas.values(), &mPendingShas);
+
+   endResetModel();
+}
+
+void ShaFilterProxyModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+   if (parent.isValid())
+      return;
+
+   const auto count = last - first + 1;
+
+   // The accepted commits below the new rows move down, but keep their order: the rows of the proxy don't change.
+   for (auto iter = std::lower_bound(mRows.begin(), mRows.end(), first); iter != mRows.end(); ++iter)
+      *iter += count;
+
+   if (mPendingShas.isEmpty())
+      return;
+
+   QSet<QString> unresolved;
+   const auto newRows = resolve(mPendingShas.values(), &unresolved);
+
+   mPendingShas = unresolved;
+
+   insertSourceRows(newRows);
+}
+
+void ShaFilterProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                              const QVector<int> &roles)
+{
+   const auto first = std::lower_bound(mRows.cbegin(), mRows.cend(), topLeft.row());
+   const auto last = std::upper_bound(first, mRows.cend(), bottomRight.row());
+
+   if (first == last)
+      return;
+
+   emit dataChanged(index(static_cast<int>(first - mRows.cbegin()), topLeft.column()),
+                    index(static_cast<int>(last - mRows.cbegin()) - 1, bottomRight.column()), roles);
 }
@@ -23,14 +23,25 @@
  ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  ***************************************************************************************/
 
-#include <QSortFilterProxyModel>
+
+#include <QAbstractProxyModel>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+class GitCache;
 
 /**
- * @brief The ShaFilterProxyModel class is an overload of the QSortFilterProxyModel that takes a list of shas to act as
- * a filter between a view and a QAbstractiItemModel.
+ * @brief The ShaFilterProxyModel class is a proxy model that only shows the commits of the source model whose SHA is
+ * among a list of accepted SHAs.
  *
+ * The SHAs are resolved to source rows once through the commits map of the cache, and the proxy keeps them as a sorted
+ * vector: mapping an index to the source is a lookup and mapping it from the source a binary search. SHAs can be added
+ * without resetting the model. When the source inserts rows, the accepted rows are shifted and only the SHAs that the
+ * source didn't have yet are resolved.
  */
-class ShaFilterProxyModel : public QSortFilterProxyModel
+class ShaFilterProxyModel : public QAbstractProxyModel
 {
    Q_OBJECT
 
@@ -38,41 +49,43 @@ public:
    /**
     * @brief Default constructor.
     *
+    * @param cache The cache that resolves the SHAs to rows of the source model.
     * @param parent The parent widget if needed.
     */
-   explicit ShaFilterProxyModel(QObject *parent = nullptr);
+   explicit ShaFilterProxyModel(const QSharedPointer<GitCache> &cache, QObject *parent = nullptr);
+
+   void setSourceModel(QAbstractItemModel *sourceModel) override;
 
    /**
-    * @brief Sets the list of accepted SHAs that will be shown in the source model.
+    * @brief Sets the list of accepted SHAs that will be shown in the source model. The model is reset.
     *
     * @param acceptedShaList The SHAs list.
     */
-   void setAcceptedSha(const QStringList &acceptedShaList) { mAcceptedShas = acceptedShaList; }
-   /**
-    * @brief Starts the reset of the model
-    *
-    */
-   void beginResetModel() { QSortFilterProxyModel::beginResetModel(); }
+   void setAcceptedSha(const QStringList &acceptedShaList);
    /**
-    * @brief Ends the reset of the model.
+    * @brief Adds SHAs to the accepted ones. Only the rows of the new SHAs are inserted in the model.
     *
+    * @param shaList The SHAs to add.
     */
-   void endResetModel() { QSortFilterProxyModel::endResetModel(); }
+   void addAcceptedSha(const QStringList &shaList);
 
-protected:
-   /**
-    * @brief This method is the actual filter functionality. Given the source row and the source index it retrieves the
-    * sha and checks if it's among the accepted SHAs in the list.
-    *
-    * @param sourceRow The source row number.
-    * @param sourceParent The source index.
-    * @return bool Returns true if the source row should be shown in the view.
-    */
-   bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+   QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+   QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+   QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+   QModelIndex parent(const QModelIndex &child) const override;
+   int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+   int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+   bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
 
 private:
-   /**
-    * @brief mAcceptedShas List of accepted shas.
-    */
-   QStringList mAcceptedShas;
+   QSharedPointer<GitCache> mCache;
+   QSet<QString> mAcceptedShas;
+   QSet<QString> mPendingShas; // Accepted SHAs that are not in the source model yet.
+   QVector<int> mRows; // Sorted source rows of the accepted SHAs.
+
+   QVector<int> resolve(const QStringList &shaList, QSet<QString> *unresolved) const;
+   void resolveAll();
+   void insertSourceRows(const QVector<int> &newRows);
+   void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+   void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
 };
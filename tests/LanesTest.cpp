@@ -0,0 +1,244 @@
+/****************************************************************************************
+ ** GitQlient is an application to manage and operate one or several Git repositories. With
+ ** GitQlient you will be able to add commits, branches and manage all the options Git provides.
+ ** Copyright (C) 2021  Francesc Martinez
+ **
+ ** LinkedIn: www.linkedin.com/in/cescmm/
+ ** Web: www.francescmm.com
+ **
+ ** This program is free software; you can redistribute it and/or
+ ** modify it under the terms of the GNU Lesser General Public
+ ** License as published by the Free Software Foundation; either
+ ** version 2 of the License, or (at your option) any later version.
+ **
+ ** This program is distributed in the hope that it will be useful,
+ ** but WITHOUT ANY WARRANTY; without even the implied warranty of
+ ** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ ** Lesser General Public License for more details.
+ **
+ ** You should have received a copy of the GNU Lesser General Public
+ ** License along with this library; if not, write to the Free Software
+ ** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ ***************************************************************************************/
+
+#include <LanesReference.h>
+#include <lanes.h>
+
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTest>
+
+#include <algorithm>
+
+namespace
+{
+// A synthetic history in topological order: the parents of every row are later rows or commits outside the graph.
+struct Graph
+{
+   QVector<QVector<int>> parents; // Row of each parent, or -(k + 1) for the k-th external commit.
+};
+
+Graph randomGraph(quint32 seed, int rows, int window, int mergePercent, int rootPercent, int externalPercent)
+{
+   QRandomGenerator random(seed);
+   Graph graph;
+   auto externals = 0;
+
+   graph.parents.resize(rows);
+
+   for (auto row = 0; row < rows; ++row)
+   {
+      auto &parents = graph.parents[row];
+      auto count = 1;
+
+      if (static_cast<int>(random.bounded(100)) < rootPercent)
+         count = 0;
+      else if (static_cast<int>(random.bounded(100)) < mergePercent)
+         count = 2 + static_cast<int>(random.bounded(2));
+
+      for (auto i = 0; i < count; ++i)
+      {
+         const auto last = std::min(rows - 1, row + window);
+         auto parent = 0;
+
+         if (row == rows - 1 || static_cast<int>(random.bounded(100)) < externalPercent)
+            parent = -(++externals);
+         else
+            parent = row + 1 + static_cast<int>(random.bounded(last - row));
+
+         if (!parents.contains(parent))
+            parents.append(parent);
+      }
+   }
+
+   return graph;
+}
+
+QString sha(int reference)
+{
+   return reference >= 0 ? QString::fromLatin1("c%1").arg(reference) : QString::fromLatin1("x%1").arg(-reference);
+}
+
+// Same mapping LaneLayout uses: rows are their own id and external commits take the negative ids below NO_COMMIT.
+int id(int reference)
+{
+   return reference >= 0 ? reference : reference - 1;
+}
+
+QVector<QVector<Lane>> referenceLanes(const Graph &graph)
+{
+   QVector<QVector<Lane>> rows;
+   LanesReference lanes;
+
+   lanes.init(sha(0));
+
+   for (auto row = 0; row < graph.parents.count(); ++row)
+   {
+      QStringList parents;
+
+      for (const auto parent : graph.parents.at(row))
+         parents.append(sha(parent));
+
+      const auto commit = sha(row);
+      bool isDiscontinuity;
+      const auto isFork = lanes.isFork(commit, isDiscontinuity);
+      const auto isMerge = parents.count() > 1;
+
+      if (isDiscontinuity)
+         lanes.changeActiveLane(commit);
+
+      if (isFork)
+         lanes.setFork(commit);
+      if (isMerge)
+         lanes.setMerge(parents);
+      if (parents.isEmpty())
+         lanes.setInitial();
+
+      rows.append(lanes.getLanes());
+
+      lanes.nextParent(parents.isEmpty() ? QString() : parents.first());
+
+      if (isMerge)
+         lanes.afterMerge();
+      if (isFork)
+         lanes.afterFork();
+      if (lanes.isBranch())
+         lanes.afterBranch();
+   }
+
+   return rows;
+}
+
+QVector<QVector<Lane>> currentLanes(const Graph &graph)
+{
+   QVector<QVector<Lane>> rows;
+   Lanes lanes;
+
+   lanes.init(0);
+
+   for (auto row = 0; row < graph.parents.count(); ++row)
+   {
+      QVector<int> parents;
+
+      for (const auto parent : graph.parents.at(row))
+         parents.append(id(parent));
+
+      bool isDiscontinuity;
+      const auto isFork = lanes.isFork(row, isDiscontinuity);
+      const auto isMerge = parents.count() > 1;
+
+      if (isDiscontinuity)
+         lanes.changeActiveLane(row);
+
+      if (isFork)
+         lanes.setFork(row);
+      if (isMerge)
+         lanes.setMerge(parents);
+      if (parents.isEmpty())
+         lanes.setInitial();
+
+      rows.append(lanes.getLanes());
+
+      lanes.nextParent(parents.isEmpty() ? Lanes::NO_COMMIT : parents.constFirst());
+
+      if (isMerge)
+         lanes.afterMerge();
+      if (isFork)
+         lanes.afterFork();
+      if (lanes.isBranch())
+         lanes.afterBranch();
+   }
+
+   return rows;
+}
+
+QString describe(const QVector<Lane> &lanes)
+{
+   QStringList types;
+
+   for (const auto &lane : lanes)
+      types.append(QString::number(static_cast<int>(lane.getType())));
+
+   return types.join(QStringLiteral(" "));
+}
+}
+
+class LanesTest : public QObject
+{
+   Q_OBJECT
+
+private slots:
+   void sameLanesAsReference_data();
+   void sameLanesAsReference();
+};
+
+void LanesTest::sameLanesAsReference_data()
+{
+   QTest::addColumn<quint32>("seed");
+   QTest::addColumn<int>("rows");
+   QTest::addColumn<int>("window");
+   QTest::addColumn<int>("mergePercent");
+   QTest::addColumn<int>("rootPercent");
+   QTest::addColumn<int>("externalPercent");
+
+   for (quint32 seed = 1; seed <= 20; ++seed)
+   {
+      QTest::addRow("linear, seed %u", seed) << seed << 200 << 1 << 0 << 0 << 0;
+      QTest::addRow("forks and merges, seed %u", seed) << seed << 500 << 8 << 20 << 1 << 1;
+      QTest::addRow("many lanes, seed %u", seed) << seed << 800 << 120 << 35 << 2 << 2;
+      QTest::addRow("octopus merges, seed %u", seed) << seed << 300 << 40 << 70 << 0 << 5;
+   }
+}
+
+void LanesTest::sameLanesAsReference()
+{
+   QFETCH(quint32, seed);
+   QFETCH(int, rows);
+   QFETCH(int, window);
+   QFETCH(int, mergePercent);
+   QFETCH(int, rootPercent);
+   QFETCH(int, externalPercent);
+
+   const auto graph = randomGraph(seed, rows, window, mergePercent, rootPercent, externalPercent);
+   const auto expected = referenceLanes(graph);
+   const auto actual = currentLanes(graph);
+
+   QCOMPARE(actual.count(), expected.count());
+
+   for (auto row = 0; row < expected.count(); ++row)
+   {
+      if (actual.at(row) != expected.at(row))
+      {
+         const auto message = QString::fromLatin1("Row %1: expected {%2} but got {%3}")
+                                  .arg(row)
+                                  .arg(describe(expected.at(row)), describe(actual.at(row)))
+                                  .toLatin1();
+
+         QFAIL(message.constData());
+      }
+   }
+}
+
+QTEST_APPLESS_MAIN(LanesTest)
+
+#include "LanesTest.moc"